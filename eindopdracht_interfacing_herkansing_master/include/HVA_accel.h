@@ -8,6 +8,42 @@
 //Hier wordt het Mode register gedefinieerd. Deze wordt gebruikt om de accelerometer van mode te veranderen.
 #define ACC_MODE 0x07
 #define ACC_WAKE 0b00000001
+#define ACC_STANDBY 0b00000000
+
+//Interrupt register. ACQ_INT geeft een interrupt op de INTN pin bij elke nieuwe meting,
+//met AUTO_CLR wordt die interrupt vanzelf weer gewist zodat elke meting een flank geeft.
+#define ACC_INTR_CTRL 0x06
+#define ACC_ACQ_INT_EN 0b10000000
+#define ACC_AUTO_CLR_EN 0b01000000
+
+//Sample rate register. Dit register mag alleen in standby geschreven worden.
+#define ACC_SR 0x08
+#define ACC_SR_25HZ 0x10
+#define ACC_SR_50HZ 0x11
+#define ACC_SR_100HZ 0x13
+#define ACC_SR_125HZ 0x14
+#define ACC_SR_250HZ 0x15
+#define ACC_SR_500HZ 0x16
+#define ACC_SR_1000HZ 0x17
+
+//Bereik en laagdoorlaatfilter. Bits 6..4 zijn het bereik, bit 3 zet het filter aan
+//en bits 2..0 kiezen de kantelfrequentie als deel van de sample rate.
+//Ook dit register mag alleen in standby geschreven worden.
+#define ACC_RANGE 0x20
+#define ACC_RANGE_G2 0b00000000
+#define ACC_RANGE_G4 0b00010000
+#define ACC_RANGE_G8 0b00100000
+#define ACC_RANGE_G16 0b00110000
+#define ACC_RANGE_G12 0b01000000
+#define ACC_LPF_EN 0b00001000
+#define ACC_LPF_DIV4 0b00000001
+#define ACC_LPF_DIV6 0b00000010
+#define ACC_LPF_DIV12 0b00000011
+#define ACC_LPF_DIV16 0b00000101
+
+//Instellingen van de INTN pinnen. INTN1 wordt push-pull en actief laag.
+#define ACC_GPIO_CTRL 0x33
+#define ACC_INTN1_PUSHPULL 0b00000100
 
 //Hier worden het lees adres, schrijf adres en ID van de accelerometer gedefinieerd. ACC=accelerometer.
 #define ACC_ID 0x4C
@@ -22,6 +58,9 @@
 #define ZOUT_EX_L 0x11 
 #define ZOUT_EX_H 0x12
 
+//Aantal bytes van XOUT_EX_L t/m ZOUT_EX_H, in een keer uit te lezen omdat het adres automatisch ophoogt.
+#define ACC_BURST_LEN 6
+
 //Hier worden de verschillende meetswaarden per bit gedefinieerd.
 //ValpBit staat voor Value per Bit.
 #define ValpBit_G2 0.000061
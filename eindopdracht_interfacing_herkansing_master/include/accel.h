@@ -0,0 +1,52 @@
+/*!
+ * \file    accel.h
+ * \brief   Driver for the accelerometer of the HvA board (HVA_accel.h).
+ *
+ *          accel_init() puts the sensor in standby, writes the sample rate,
+ *          the range with the low-pass filter and the interrupt settings
+ *          from an accel_config_t over I2C and wakes the sensor again.
+ *
+ *          The raw counts are converted to Q4.11 g (see telemetry.h) with
+ *          accel_scale(). The factor per range comes from constant tables
+ *          and is a multiply and a shift, no floating point: in the 2, 4,
+ *          8 and 16 g ranges 1 g is 16384, 8192, 4096 and 2048 counts, only
+ *          a shift; in the 12 g range 1 g is about 2731 counts, which is
+ *          times 3/4.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef ACCEL_H
+#define ACCEL_H
+
+#include <stdint.h>
+
+/* Ranges, the values are the range field of the sensor */
+#define ACCEL_RANGE_2G      0
+#define ACCEL_RANGE_4G      1
+#define ACCEL_RANGE_8G      2
+#define ACCEL_RANGE_16G     3
+#define ACCEL_RANGE_12G     4
+#define ACCEL_RANGES        5
+
+/* Low-pass filter, cut-off frequency as part of the sample rate */
+#define ACCEL_LPF_OFF       0
+#define ACCEL_LPF_DIV4      1
+#define ACCEL_LPF_DIV6      2
+#define ACCEL_LPF_DIV12     3
+#define ACCEL_LPF_DIV16     4
+
+#define ACCEL_OK            0
+#define ACCEL_ERR_CONFIG    1   // range, rate or filter not supported
+#define ACCEL_ERR_I2C       2   // the sensor did not acknowledge
+
+typedef struct {
+    uint8_t range;      // ACCEL_RANGE_...
+    uint16_t rate_hz;   // 25, 50, 100, 125, 250, 500 or 1000
+    uint8_t lpf;        // ACCEL_LPF_...
+    uint8_t drdy;       // non-zero: INTN1 pulses low on every new sample
+} accel_config_t;
+
+uint8_t accel_init(const accel_config_t *config);
+int16_t accel_scale(int16_t raw);
+
+#endif /* ACCEL_H */
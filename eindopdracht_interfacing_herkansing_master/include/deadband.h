@@ -0,0 +1,35 @@
+/*!
+ * \file    deadband.h
+ * \brief   Change detection on the filtered samples, so a board that lies
+ *          still does not keep the radio busy.
+ *
+ *          deadband_check() compares a sample with the last sample that was
+ *          sent. It is sent when one of the axes moved more than the
+ *          threshold (in Q4.11 g), or when the last sent sample is older
+ *          than the keepalive time, so the slave still hears from the
+ *          master. All other samples are suppressed. The slave keeps using
+ *          the last sample it received, so a suppressed sample changes
+ *          nothing there. A threshold of 0 sends every sample.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+#include <stdint.h>
+#include "telemetry.h"
+
+typedef struct {
+    int16_t threshold;      // Q4.11 g
+    uint32_t keepalive_us;
+    int16_t last[3];        // last sent sample
+    uint32_t last_time;     // timestamp of the last sent sample
+    uint8_t started;        // a sample has been sent
+    uint32_t sent;
+    uint32_t suppressed;
+} deadband_t;
+
+void deadband_init(deadband_t *d, int16_t threshold, uint32_t keepalive_us);
+uint8_t deadband_check(deadband_t *d, const telemetry_sample_t *s);
+
+#endif /* DEADBAND_H */
@@ -0,0 +1,49 @@
+/*!
+ * \file    filter.h
+ * \brief   Decimating low-pass filter for the accelerometer samples.
+ *
+ *          Every sample from the sensor is put in the filter with
+ *          filter_put(); every decimate-th sample a filtered sample comes
+ *          out, which is sent. So the sensor can run at a high rate while
+ *          the radio carries a lower one. The filter works on the three
+ *          axes in Q4.11 g, with integer math only:
+ *
+ *          - FILTER_MA: moving average over the block of decimate samples
+ *            (boxcar), rounded to the nearest Q4.11 value.
+ *          - FILTER_IIR: first order low-pass y += (x - y) / 2^shift on
+ *            every sample, with FILTER_IIR_FRAC extra fractional bits in
+ *            the state. The first sample sets the state. The -3 dB point is
+ *            about rate / (2 pi 2^shift).
+ *          - FILTER_NONE: only decimation, the last sample of the block.
+ *
+ *          The filtered sample gets the timestamp of the last sample of the
+ *          block; the sequence number is left to the caller.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include "telemetry.h"
+
+#define FILTER_NONE         0
+#define FILTER_MA           1
+#define FILTER_IIR          2
+
+#define FILTER_IIR_FRAC     8   // extra fractional bits of the IIR state
+#define FILTER_MAX_SHIFT    8
+
+typedef struct {
+    uint8_t mode;       // FILTER_...
+    uint8_t decimate;   // samples in, per sample out (1..255)
+    uint8_t shift;      // FILTER_IIR: 1 / 2^shift is the weight of a new sample
+    uint8_t count;      // samples in the current block
+    uint8_t primed;     // FILTER_IIR: the state holds a sample
+    int32_t acc[3];     // FILTER_MA: sum of the block, FILTER_IIR: state
+} filter_t;
+
+void filter_init(filter_t *f, uint8_t mode, uint8_t decimate, uint8_t shift);
+uint8_t filter_put(filter_t *f, const telemetry_sample_t *in, telemetry_sample_t *out);
+
+#endif /* FILTER_H */
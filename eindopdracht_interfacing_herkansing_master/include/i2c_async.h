@@ -0,0 +1,30 @@
+/*
+ * i2c_async.h
+ *
+ * Interrupt driven register read for the TWI master on I2C_ASYNC_TWI.
+ * i2c_async_read() writes the register address, does a repeated start and
+ * reads len bytes (the slave increments the register address itself). It
+ * returns at once; the bytes are moved by the TWI interrupt and the
+ * callback is called from the interrupt when the transaction is done.
+ *
+ * Call i2c_init() first. The blocking functions of i2c.h may be used on
+ * the same TWI when no asynchronous read is busy.
+ */
+
+#ifndef I2C_ASYNC_H
+#define I2C_ASYNC_H
+
+#include <avr/io.h>
+#include <stdint.h>
+#include "i2c.h"
+
+#define I2C_ASYNC_TWI      TWIE
+#define I2C_ASYNC_VECT     TWIE_TWIM_vect
+
+typedef void (*i2c_async_callback_t)(uint8_t status);
+
+uint8_t i2c_async_read(uint8_t address, uint8_t reg, uint8_t *buf, uint8_t len,
+                       i2c_async_callback_t callback);
+uint8_t i2c_async_busy(void);
+
+#endif /* I2C_ASYNC_H */
@@ -0,0 +1,58 @@
+/*!
+ *  \file    nrf24tx.h
+ *  \date    16-10-2026
+ *  \version 1.3
+ *  \brief   Interrupt driven, pipelined transmit for the Nordic NRF24L01p
+ *  \details nrfTxSend() puts a payload in the TX FIFO of the radio and
+ *           returns at once. Up to NRF_TX_FIFO_SIZE payloads can be queued;
+ *           CE is held high as long as there is a payload in the FIFO, so
+ *           the radio sends them back-to-back, each with its own
+ *           acknowledge. An acknowledged payload leaves the FIFO, so on
+ *           every TX_DS interrupt the payloads that are no longer in the
+ *           FIFO (FIFO_STATUS) are complete, also when one interrupt covers
+ *           more than one payload. On MAX_RT the FIFO is drained: the
+ *           payloads that left it are complete, the failing payload and the
+ *           payloads queued behind it are dropped.
+ *
+ *           A one-shot timer on TCD0 guards against a lost interrupt; it
+ *           drains the FIFO the same way, so a payload whose TX_DS was lost
+ *           still counts as acknowledged when it has left the FIFO. The
+ *           result of every payload is passed to the callback given to
+ *           nrfTxInit(), which runs in interrupt context.
+ *
+ *           The radio stays a primary transmitter (PRIM_RX is 0): when the
+ *           FIFO is empty CE goes low and the radio waits in standby. There
+ *           is no switching to receive mode and back, the settling times
+ *           are left to the radio itself. Data from the receiver comes back
+ *           in the acknowledge payloads (nrfEnableAckPayload() on both
+ *           sides) and is passed to the acknowledge callback.
+ *
+ *           This module owns the interrupt vectors NRF24_IRQ_VEC and
+ *           TCD0_OVF_vect.
+ */
+#ifndef __nrf24tx_H__
+#define __nrf24tx_H__
+
+#include <stdint.h>
+
+#define NRF_TX_TIMER        TCD0
+#define NRF_TX_TIMER_VEC    TCD0_OVF_vect
+#define NRF_TX_FIFO_SIZE    3
+
+/*!
+ *  \brief Result of a payload, passed to the callback
+ */
+#define NRF_TX_OK           0   //!< Acknowledge received (TX_DS)
+#define NRF_TX_MAX_RT       1   //!< Maximum number of retransmits (MAX_RT)
+#define NRF_TX_TIMEOUT      2   //!< No interrupt within the timeout
+#define NRF_TX_FLUSHED      3   //!< Dropped from the FIFO after a failure
+
+typedef void (*nrfTxCallback_t)(uint8_t status);
+typedef void (*nrfTxAckCallback_t)(const uint8_t *buf, uint8_t len);
+
+void    nrfTxInit(nrfTxCallback_t callback, nrfTxAckCallback_t ackCallback);
+uint8_t nrfTxSend(const uint8_t *buf, uint8_t len);
+uint8_t nrfTxBusy(void);
+uint8_t nrfTxPending(void);
+
+#endif // __nrf24tx_H__
@@ -0,0 +1,54 @@
+/*!
+ * \file    sampler.h
+ * \brief   Accelerometer sampling driven by its data-ready interrupt.
+ *
+ *          The accelerometer is set up by accel_init() with drdy on, so it
+ *          pulses INTN1 on every new sample. INTN1 is wired to
+ *          SAMPLER_INT_PIN; sampler_init() enables the pin interrupt and
+ *          takes the data rate of the sensor. Every falling edge takes a
+ *          timestamp and starts the interrupt driven burst read of
+ *          i2c_async. When the read is done the buffers are swapped and
+ *          sampler_get() hands out the sample. The sensor sets the pace, so
+ *          every sample is read exactly once.
+ *
+ *          The time between two edges is checked against the period of the
+ *          data rate:
+ *          - more than 1.5 periods: the edges in between were lost, they
+ *            are counted as missed;
+ *          - less than half a period: the edge is counted as a duplicate
+ *            and no read is started, so the same sample is not sent twice.
+ *          A sample is dropped when its edge comes while the previous read
+ *          is still busy, or when it is overwritten before sampler_get()
+ *          took it.
+ *
+ *          This module owns the interrupt vector SAMPLER_INT_VEC and uses
+ *          i2c_async; call i2c_init() and timestamp_init() first.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdint.h>
+
+/* INTN1 of the accelerometer */
+#define SAMPLER_INT_PORT    PORTE
+#define SAMPLER_INT_PIN     PIN2_bm
+#define SAMPLER_INT_CTRL    PIN2CTRL
+#define SAMPLER_INT_VEC     PORTE_INT0_vect
+
+typedef struct {
+    uint32_t samples;   // samples read
+    uint16_t dropped;   // read still busy, or overwritten before it was taken
+    uint16_t missed;    // edges that did not come (gap of more than 1.5 periods)
+    uint16_t duplicate; // edges within half a period of the previous one
+    uint16_t errors;    // failed I2C reads
+} sampler_stats_t;
+
+void sampler_init(uint16_t rate_hz);
+uint8_t sampler_get(uint8_t *raw, uint32_t *timestamp);
+void sampler_get_stats(sampler_stats_t *stats);
+void sampler_reset_stats(void);
+void sampler_print(void);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,126 @@
+/*!
+ * \file    accel.c
+ * \brief   Driver for the accelerometer of the HvA board, see accel.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "accel.h"
+
+#include <stddef.h>
+#include <avr/io.h>
+#include "i2c.h"
+#include "HVA_accel.h"
+
+#define ACCEL_TWI   TWIE
+
+typedef struct {
+    uint16_t hz;
+    uint8_t sr;
+} accel_rate_t;
+
+static const accel_rate_t accel_rates[] = {
+    {   25, ACC_SR_25HZ   },
+    {   50, ACC_SR_50HZ   },
+    {  100, ACC_SR_100HZ  },
+    {  125, ACC_SR_125HZ  },
+    {  250, ACC_SR_250HZ  },
+    {  500, ACC_SR_500HZ  },
+    { 1000, ACC_SR_1000HZ },
+};
+
+/* Indexed by ACCEL_RANGE_... */
+static const uint8_t accel_range_bits[ACCEL_RANGES] = {
+    ACC_RANGE_G2, ACC_RANGE_G4, ACC_RANGE_G8, ACC_RANGE_G16, ACC_RANGE_G12
+};
+
+/* Q4.11 = raw * mul >> shift, indexed by ACCEL_RANGE_... */
+static const uint8_t accel_scale_mul[ACCEL_RANGES]   = { 1, 1, 1, 1, 3 };
+static const uint8_t accel_scale_shift[ACCEL_RANGES] = { 3, 2, 1, 0, 2 };
+
+/* Indexed by ACCEL_LPF_... */
+static const uint8_t accel_lpf_bits[] = {
+    0,
+    ACC_LPF_EN | ACC_LPF_DIV4,
+    ACC_LPF_EN | ACC_LPF_DIV6,
+    ACC_LPF_EN | ACC_LPF_DIV12,
+    ACC_LPF_EN | ACC_LPF_DIV16,
+};
+
+static uint8_t accel_mul = 1;
+static uint8_t accel_shift = 3;
+
+static uint8_t accel_write(uint8_t reg, uint8_t value)
+{
+    uint8_t status;
+
+    status = i2c_start(&ACCEL_TWI, ACC_ID, I2C_WRITE);
+    if (status == I2C_STATUS_OK) {
+        status = i2c_write(&ACCEL_TWI, reg);
+    }
+    if (status == I2C_STATUS_OK) {
+        status = i2c_write(&ACCEL_TWI, value);
+    }
+    i2c_stop(&ACCEL_TWI);
+
+    return status;
+}
+
+/*
+ * The rate, range and interrupt registers can only be written in standby.
+ * Returns ACCEL_OK, or an error code; the sensor is left in standby after
+ * an I2C error.
+ */
+uint8_t accel_init(const accel_config_t *config)
+{
+    uint8_t i, sr = 0;
+    uint8_t status;
+
+    if (config == NULL || config->range >= ACCEL_RANGES ||
+        config->lpf >= sizeof(accel_lpf_bits)) {
+        return ACCEL_ERR_CONFIG;
+    }
+    for (i = 0; i < sizeof(accel_rates) / sizeof(accel_rates[0]); i++) {
+        if (accel_rates[i].hz == config->rate_hz) {
+            sr = accel_rates[i].sr;
+        }
+    }
+    if (sr == 0) {
+        return ACCEL_ERR_CONFIG;
+    }
+
+    status = accel_write(ACC_MODE, ACC_STANDBY);
+    if (status == I2C_STATUS_OK) {
+        status = accel_write(ACC_SR, sr);
+    }
+    if (status == I2C_STATUS_OK) {
+        status = accel_write(ACC_RANGE, accel_range_bits[config->range] |
+                                        accel_lpf_bits[config->lpf]);
+    }
+    if (status == I2C_STATUS_OK) {
+        status = accel_write(ACC_GPIO_CTRL, ACC_INTN1_PUSHPULL);
+    }
+    if (status == I2C_STATUS_OK) {
+        status = accel_write(ACC_INTR_CTRL,
+                             config->drdy ? (ACC_ACQ_INT_EN | ACC_AUTO_CLR_EN) : 0);
+    }
+    if (status == I2C_STATUS_OK) {
+        status = accel_write(ACC_MODE, ACC_WAKE);
+    }
+    if (status != I2C_STATUS_OK) {
+        return ACCEL_ERR_I2C;
+    }
+
+    accel_mul = accel_scale_mul[config->range];
+    accel_shift = accel_scale_shift[config->range];
+
+    return ACCEL_OK;
+}
+
+/* Raw counts of one axis to Q4.11 g in the range set by accel_init() */
+int16_t accel_scale(int16_t raw)
+{
+    if (accel_mul == 1) {
+        return raw >> accel_shift;
+    }
+    return (int16_t) (((int32_t) raw * accel_mul) >> accel_shift);
+}
@@ -0,0 +1,49 @@
+/*!
+ * \file    deadband.c
+ * \brief   Change detection on the filtered samples, see deadband.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "deadband.h"
+
+void deadband_init(deadband_t *d, int16_t threshold, uint32_t keepalive_us)
+{
+    d->threshold = threshold;
+    d->keepalive_us = keepalive_us;
+    d->started = 0;
+    d->sent = 0;
+    d->suppressed = 0;
+}
+
+/* Non-zero when v differs more than threshold from last */
+static uint8_t deadband_moved(int16_t v, int16_t last, int16_t threshold)
+{
+    int32_t delta = (int32_t) v - last;
+
+    return delta > threshold || delta < -threshold;
+}
+
+/*
+ * Returns 1 when the sample has to be sent, it then becomes the reference
+ * for the next samples. Returns 0 when it is suppressed.
+ */
+uint8_t deadband_check(deadband_t *d, const telemetry_sample_t *s)
+{
+    if (d->threshold > 0 && d->started &&
+        s->timestamp - d->last_time < d->keepalive_us &&
+        !deadband_moved(s->x, d->last[0], d->threshold) &&
+        !deadband_moved(s->y, d->last[1], d->threshold) &&
+        !deadband_moved(s->z, d->last[2], d->threshold)) {
+        d->suppressed++;
+        return 0;
+    }
+
+    d->last[0] = s->x;
+    d->last[1] = s->y;
+    d->last[2] = s->z;
+    d->last_time = s->timestamp;
+    d->started = 1;
+    d->sent++;
+
+    return 1;
+}
@@ -0,0 +1,85 @@
+/*!
+ * \file    filter.c
+ * \brief   Decimating low-pass filter for the accelerometer samples, see
+ *          filter.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "filter.h"
+
+#include <stddef.h>
+
+/* Shift right by n with rounding to the nearest value */
+static int32_t filter_round_shift(int32_t v, uint8_t n)
+{
+    if (n == 0) {
+        return v;
+    }
+    return (v + ((int32_t) 1 << (n - 1))) >> n;
+}
+
+static int16_t filter_axis(filter_t *f, uint8_t axis, int16_t x)
+{
+    int32_t *acc = &f->acc[axis];
+    int32_t d;
+
+    switch (f->mode) {
+    case FILTER_MA:
+        *acc += x;
+        if (f->count + 1 < f->decimate) {
+            return 0;
+        }
+        // Average of the block, rounded half away from zero
+        d = f->decimate;
+        x = (*acc >= 0) ? (*acc + d / 2) / d : (*acc - d / 2) / d;
+        *acc = 0;
+        return x;
+    case FILTER_IIR:
+        if (!f->primed) {
+            *acc = (int32_t) x << FILTER_IIR_FRAC;
+        } else {
+            *acc += filter_round_shift(((int32_t) x << FILTER_IIR_FRAC) - *acc, f->shift);
+        }
+        return filter_round_shift(*acc, FILTER_IIR_FRAC);
+    default:
+        return x;
+    }
+}
+
+void filter_init(filter_t *f, uint8_t mode, uint8_t decimate, uint8_t shift)
+{
+    f->mode = mode;
+    f->decimate = (decimate == 0) ? 1 : decimate;
+    f->shift = (shift > FILTER_MAX_SHIFT) ? FILTER_MAX_SHIFT : shift;
+    f->count = 0;
+    f->primed = 0;
+    f->acc[0] = 0;
+    f->acc[1] = 0;
+    f->acc[2] = 0;
+}
+
+/*
+ * Put one sample in the filter. Returns 1 when a block is complete and
+ * out holds the filtered sample, 0 otherwise.
+ */
+uint8_t filter_put(filter_t *f, const telemetry_sample_t *in, telemetry_sample_t *out)
+{
+    int16_t x, y, z;
+
+    x = filter_axis(f, 0, in->x);
+    y = filter_axis(f, 1, in->y);
+    z = filter_axis(f, 2, in->z);
+    f->primed = 1;
+
+    if (++f->count < f->decimate) {
+        return 0;
+    }
+    f->count = 0;
+
+    out->x = x;
+    out->y = y;
+    out->z = z;
+    out->timestamp = in->timestamp;
+
+    return 1;
+}
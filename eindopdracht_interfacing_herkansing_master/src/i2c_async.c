@@ -0,0 +1,94 @@
+/*
+ * i2c_async.c
+ *
+ * Interrupt driven register read for the TWI master, see i2c_async.h.
+ * The transaction is: start, address+W, register, repeated start,
+ * address+R, len bytes (ack on all but the last), stop.
+ */
+
+#include <stddef.h>
+#include <avr/interrupt.h>
+#include "i2c_async.h"
+
+#define STATE_IDLE      0
+#define STATE_ADDRESS   1   // address+W sent
+#define STATE_REGISTER  2   // register sent
+#define STATE_READ      3   // address+R sent, receiving
+
+static volatile uint8_t state = STATE_IDLE;
+static uint8_t  slave;
+static uint8_t  regAddress;
+static uint8_t *data;
+static uint8_t  count;
+static uint8_t  received;
+static i2c_async_callback_t done;
+
+static void finish(uint8_t status);
+
+uint8_t i2c_async_read(uint8_t address, uint8_t reg, uint8_t *buf, uint8_t len,
+                       i2c_async_callback_t callback)
+{
+  if ( state != STATE_IDLE || len == 0 ) return I2C_STATUS_BUSY;
+  if ( (I2C_ASYNC_TWI.MASTER.STATUS & TWI_MASTER_BUSSTATE_gm) !=            // if bus not available
+       TWI_MASTER_BUSSTATE_IDLE_gc ) return I2C_STATUS_BUSY;
+
+  slave      = address;
+  regAddress = reg;
+  data       = buf;
+  count      = len;
+  received      = 0;
+  done       = callback;
+  state      = STATE_ADDRESS;
+
+  I2C_ASYNC_TWI.MASTER.CTRLA |= TWI_MASTER_INTLVL_LO_gc |                  // interrupts on
+                                TWI_MASTER_RIEN_bm | TWI_MASTER_WIEN_bm;
+  I2C_ASYNC_TWI.MASTER.ADDR = (address << 1) | I2C_WRITE;                  // send slave address
+
+  return I2C_STATUS_OK;
+}
+
+uint8_t i2c_async_busy(void)
+{
+  return state != STATE_IDLE;
+}
+
+static void finish(uint8_t status)
+{
+  I2C_ASYNC_TWI.MASTER.CTRLA &= ~(TWI_MASTER_INTLVL_gm |                    // interrupts off
+                                  TWI_MASTER_RIEN_bm | TWI_MASTER_WIEN_bm);
+  state = STATE_IDLE;
+  if ( done != NULL ) done(status);
+}
+
+ISR(I2C_ASYNC_VECT)
+{
+  uint8_t status = I2C_ASYNC_TWI.MASTER.STATUS;
+
+  if ( status & (TWI_MASTER_ARBLOST_bm | TWI_MASTER_BUSERR_bm) ) {          // bus error
+    I2C_ASYNC_TWI.MASTER.STATUS = status | TWI_MASTER_ARBLOST_bm | TWI_MASTER_BUSERR_bm;
+    I2C_ASYNC_TWI.MASTER.STATUS = TWI_MASTER_BUSSTATE_IDLE_gc;
+    finish(I2C_STATUS_BUSY);
+    return;
+  }
+
+  if ( status & TWI_MASTER_WIF_bm ) {
+    if ( status & TWI_MASTER_RXACK_bm ) {                                    // if no ack
+      I2C_ASYNC_TWI.MASTER.CTRLC = TWI_MASTER_CMD_STOP_gc;
+      finish(I2C_STATUS_NO_ACK);
+    } else if ( state == STATE_ADDRESS ) {
+      state = STATE_REGISTER;
+      I2C_ASYNC_TWI.MASTER.DATA = regAddress;                                // send register
+    } else {
+      state = STATE_READ;
+      I2C_ASYNC_TWI.MASTER.ADDR = (slave << 1) | I2C_READ;                   // repeated start
+    }
+  } else if ( status & TWI_MASTER_RIF_bm ) {
+    data[received++] = I2C_ASYNC_TWI.MASTER.DATA;                               // read data
+    if ( received < count ) {
+      I2C_ASYNC_TWI.MASTER.CTRLC = TWI_MASTER_CMD_RECVTRANS_gc;              // send ack (go on)
+    } else {
+      I2C_ASYNC_TWI.MASTER.CTRLC = TWI_MASTER_ACKACT_bm|TWI_MASTER_CMD_STOP_gc; // nack and stop
+      finish(I2C_STATUS_OK);
+    }
+  }
+}
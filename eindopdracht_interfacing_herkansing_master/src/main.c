@@ -18,18 +18,123 @@
 #include "nrf24_pindef.h"
 #include "nrf24L01.h"
 #include "nrf24spiXM2.h"
+#include "nrf24tx.h"
 #include <string.h>
 #include "i2c.h"
 #include "HVA_accel.h"
+#include "telemetry.h"
+#include "timestamp.h"
+#include "accel.h"
+#include "sampler.h"
+#include "filter.h"
+#include "deadband.h"
 
 
 #define NRF_CHANNEL  76
 
+// Zet deze aan om de metingen compact te versturen: de eerste meting van een pakket
+// volledig, de volgende als verschil met de meting ervoor (zie telemetry.h). Er
+// passen dan tot TELEMETRY_DELTA_MAX_BATCH (6) metingen in een pakket. Bij grote
+// verschillen wordt het een gewoon pakket, dus nooit minder dan TELEMETRY_MAX_BATCH (3).
+#define TELEMETRY_DELTA
+
+// Aantal metingen dat verzameld wordt voor het verzenden, aan te passen bij het
+// bouwen met -DTELEMETRY_BATCH=n. Compact gaat het in zo weinig mogelijk pakketten,
+// anders is het precies een pakket.
+#ifdef TELEMETRY_DELTA
+#define TELEMETRY_BATCH_MAX TELEMETRY_DELTA_MAX_BATCH
+#else
+#define TELEMETRY_BATCH_MAX TELEMETRY_MAX_BATCH
+#endif
+#ifndef TELEMETRY_BATCH
+#define TELEMETRY_BATCH TELEMETRY_BATCH_MAX
+#endif
+#if TELEMETRY_BATCH < 1 || TELEMETRY_BATCH > TELEMETRY_BATCH_MAX
+#error "TELEMETRY_BATCH moet tussen 1 en TELEMETRY_BATCH_MAX liggen"
+#endif
+
+// Aantal metingen en grootte van een pakket in het slechtste geval, voor de
+// controle hieronder of de radio het bij kan houden.
+#ifdef TELEMETRY_DELTA
+#define TELEMETRY_PACKET_SAMPLES \
+  (TELEMETRY_BATCH < TELEMETRY_MAX_BATCH ? TELEMETRY_BATCH : TELEMETRY_MAX_BATCH)
+#define TELEMETRY_PACKET_SIZE TELEMETRY_MAX_SIZE
+#else
+#define TELEMETRY_PACKET_SAMPLES TELEMETRY_BATCH
+#define TELEMETRY_PACKET_SIZE TELEMETRY_SIZE(TELEMETRY_BATCH)
+#endif
+
+// Instellingen van de accelerometer, aan te passen bij het bouwen met bijvoorbeeld
+// -DACCEL_RANGE=ACCEL_RANGE_8G -DACCEL_RATE_HZ=1000 (zie accel.h).
+#ifndef ACCEL_RANGE
+#define ACCEL_RANGE ACCEL_RANGE_2G
+#endif
+#ifndef ACCEL_RATE_HZ
+#define ACCEL_RATE_HZ 500
+#endif
+#ifndef ACCEL_LPF
+#define ACCEL_LPF ACCEL_LPF_OFF
+#endif
+
+// Filter op de master (zie filter.h). Van elke FILTER_DECIMATE metingen wordt er
+// een gefilterde verzonden, bijvoorbeeld -DFILTER_MODE=FILTER_IIR -DFILTER_SHIFT=3.
+#ifndef FILTER_MODE
+#define FILTER_MODE FILTER_MA
+#endif
+#ifndef FILTER_DECIMATE
+#define FILTER_DECIMATE 4
+#endif
+#ifndef FILTER_SHIFT
+#define FILTER_SHIFT 2
+#endif
+#if FILTER_DECIMATE < 1 || FILTER_DECIMATE > 255
+#error "FILTER_DECIMATE moet tussen 1 en 255 liggen"
+#endif
+
+// Een gefilterde meting wordt alleen verzonden als een as meer dan DEADBAND_THRESHOLD
+// (Q4.11, 2048 is 1 g) veranderd is ten opzichte van de vorige verzonden meting, of
+// als er DEADBAND_KEEPALIVE_MS niets verzonden is. Met 0 wordt alles verzonden.
+#ifndef DEADBAND_THRESHOLD
+#define DEADBAND_THRESHOLD 32
+#endif
+#ifndef DEADBAND_KEEPALIVE_MS
+#define DEADBAND_KEEPALIVE_MS 500
+#endif
+
+// De accelerometer bepaalt het tempo van de metingen, na het filter gaan er
+// ACCEL_RATE_HZ / FILTER_DECIMATE per seconde naar de radio. De radio moet de
+// pakketten bij kunnen houden, ook zonder herhalingen is dat de bovengrens.
+#if ACCEL_RATE_HZ * TELEMETRY_AIRTIME_US(TELEMETRY_PACKET_SIZE) > 1000000UL * TELEMETRY_PACKET_SAMPLES * FILTER_DECIMATE
+#error "ACCEL_RATE_HZ is te hoog voor de radio, verhoog TELEMETRY_BATCH of FILTER_DECIMATE of verlaag de rate"
+#endif
+
+const accel_config_t accelConfig = {
+  .range = ACCEL_RANGE,
+  .rate_hz = ACCEL_RATE_HZ,
+  .lpf = ACCEL_LPF,
+  .drdy = 1,
+};
+
+// Zet deze aan om de eerste meting van elke verzending te printen. Het printen
+// wacht op de UART, dus alleen om te debuggen.
+//#define DEBUG_SAMPLES
+
 // Hier worden alle globalen variabelen en arrays gedefinieerd.
 uint8_t rx_packet[128];
 uint8_t master[5] = "MTOSP"; // Master to slave pipe
-uint8_t slave[5] = "STOMP"; // Slave to master pipe
-volatile int8_t measurementsFlag = 1;
+uint16_t sequenceNumber = 0;
+volatile uint16_t txFailures = 0;     // pakketten zonder ACK
+volatile uint16_t txDropped = 0;      // metingen niet verzonden, radio bezig
+volatile uint32_t txDelivered = 0;    // metingen die met een ACK zijn aangekomen
+volatile uint16_t slaveReceived = 0;  // pakketten ontvangen volgens de slave
+
+// Aantal metingen per pakket in de TX FIFO van de radio, in volgorde van verzenden.
+// Een pakket kan minder dan TELEMETRY_BATCH metingen hebben (zie deadband.h en
+// telemetry_encode_delta()).
+uint8_t txCounts[NRF_TX_FIFO_SIZE];
+uint8_t txCountIn = 0;
+volatile uint8_t txCountOut = 0;
+
 
 //deze functie is voor het uitlezen van de adc en is gebaseerd op de practicum handleiding
 /*
@@ -53,13 +158,31 @@ typedef struct {
     int8_t zHigh;
     int16_t x;
     int16_t y;
+    int16_t z;
 } AccelerometerReadings;
-  
-typedef struct {
-  float x;
-  float y;
-} ACCOmgerekend;
 
+// Deze functie wordt vanuit de NRF interrupt aangeroepen als een verzending klaar is.
+void nrfTxDone(uint8_t status){
+  if (status != NRF_TX_OK) {
+    txFailures++;
+  } else {
+    txDelivered += txCounts[txCountOut];
+  }
+  txCountOut = (txCountOut + 1) % NRF_TX_FIFO_SIZE;
+}
+
+// Deze functie wordt vanuit de NRF interrupt aangeroepen met de data uit een ACK.
+void nrfAckReceived(const uint8_t *buf, uint8_t len){
+  uint16_t received;
+
+  if (telemetry_decode_ack(&received, buf, len) == TELEMETRY_OK) {
+    slaveReceived = received;
+  }
+}
+
+// De master is altijd zender (PRIM_TX) en de slave altijd ontvanger. Data van
+// de slave naar de master komt mee in de ACK, daarom is er geen leespipe en
+// wordt er niet gewisseld tussen zenden en ontvangen.
 void nrf_init(void){
   nrfspiInit();
   nrfBegin();
@@ -70,6 +193,7 @@ void nrf_init(void){
   nrfSetChannel(NRF_CHANNEL);
   nrfSetAutoAck(1);
   nrfEnableDynamicPayloads();
+  nrfEnableAckPayload();
   nrfClearInterruptBits();
   nrfFlushRx();
   nrfFlushTx();
@@ -81,71 +205,76 @@ void nrf_init(void){
   NRF24_IRQ_PORT.INTCTRL |=
   (NRF24_IRQ_PORT.INTCTRL & ~PORT_INT0LVL_gm) | PORT_INT0LVL_LO_gc;
 
-  // Opening pipes
+  // Opening pipes. De schrijfpipe zet ook pipe 0 op hetzelfde adres, daarop komt de ACK binnen.
   nrfOpenWritingPipe((uint8_t *) master);
-  nrfOpenReadingPipe(0, (uint8_t *) slave);
-  nrfStartListening();
   nrfPowerUp();
+  nrfTxInit(nrfTxDone, nrfAckReceived);
 }
 
-void changeModeWake(TWI_t *twi){
-  i2c_start(twi, ACC_ID, I2C_WRITE);
-  i2c_write(twi, ACC_MODE);
-  i2c_write(twi, ACC_WAKE);
-  i2c_stop(twi);
-}
-
-// De versnellingen van de X-, Y- en Z-assen uit de accelerometer worden hier uitgelezen.
-uint8_t readRegisterAccelerometer(TWI_t *twi, AccelerometerReadings *ACCData){
-    i2c_start(twi, ACC_ID, I2C_WRITE);
-    i2c_write(twi, XOUT_EX_L);
-    i2c_restart(twi, ACC_ID, I2C_READ);
-    ACCData->xLow = i2c_read(twi, I2C_ACK);
-    ACCData->xHigh = i2c_read(twi, I2C_ACK);
-    ACCData->yLow = i2c_read(twi, I2C_ACK);
-    ACCData->yHigh = i2c_read(twi, I2C_NACK);
-    i2c_stop(twi);
+// De versnellingen van de X-, Y- en Z-assen worden hier uit de buffer gehaald.
+uint8_t readRegisterAccelerometer(const uint8_t *buffer, AccelerometerReadings *ACCData){
+    ACCData->xLow = buffer[0];
+    ACCData->xHigh = buffer[1];
+    ACCData->yLow = buffer[2];
+    ACCData->yHigh = buffer[3];
+    ACCData->zLow = buffer[4];
+    ACCData->zHigh = buffer[5];
   
     // Hier worden de Low en High bytes samengevoegd. 
     // Dit wordt gedaan door de high waardes 8 plekken naar links te verschuiven.
+    // De Low bytes worden als unsigned gebruikt, anders telt het tekenbit mee.
   
-    ACCData->x = (ACCData->xHigh <<8) + ACCData->xLow;
-    ACCData->y = (ACCData->yHigh <<8) + ACCData->yLow;
+    ACCData->x = (int16_t)(((uint8_t) ACCData->xHigh << 8) | (uint8_t) ACCData->xLow);
+    ACCData->y = (int16_t)(((uint8_t) ACCData->yHigh << 8) | (uint8_t) ACCData->yLow);
+    ACCData->z = (int16_t)(((uint8_t) ACCData->zHigh << 8) | (uint8_t) ACCData->zLow);
     return 0;
   }
   
-// Rekent de gemeten waardes om naar G-waarden. 
-void calculateAcceleration(AccelerometerReadings *rawData, ACCOmgerekend *RealAcceleration){
-  RealAcceleration->x = (float)(rawData->x * ValpBit_G2);
-  RealAcceleration->y = (float)(-1* rawData->y * ValpBit_G2);
-
+// Rekent de gemeten waardes om naar G-waarden in Q4.11 (zie telemetry.h).
+// De schaal hangt af van het ingestelde bereik, zie accel_scale().
+void calculateAcceleration(AccelerometerReadings *rawData, telemetry_sample_t *sample){
+  sample->x = accel_scale(rawData->x);
+  sample->y = -accel_scale(rawData->y);
+  sample->z = accel_scale(rawData->z);
 }
 
-// Hier worden alle waardes geprint naar de buffer. Vervolgens wordt deze buffer verzonden via NRF.
-void nrfSend(float x, float y){
-  char buffer[128];
-  sprintf(buffer,"%f,%f", x, y); 
-  nrfStopListening();
-  printf("%f,%f\n", x, y); 
-  cli();
-  nrfWrite((uint8_t *)buffer, strlen(buffer));
-  sei();
-  nrfStartListening();
-
-}
+// Hier worden de metingen in binaire pakketten gezet en verzonden via NRF.
+// De verzending loopt via interrupts, deze functie wacht niet op de ACK.
+// De radio kan drie pakketten in de rij hebben staan, die achter elkaar verzonden
+// worden. Als die rij vol is worden de metingen overgeslagen.
+// Compact passen niet altijd alle metingen in een pakket, de rest gaat in het volgende.
+void nrfSend(telemetry_sample_t *samples, uint8_t count){
+  uint8_t buffer[TELEMETRY_MAX_SIZE];
+  uint8_t length;
+  uint8_t used;
 
-// Deze timer wordt gebruikt om de frequentie van de metingen aan te passen.
-void init_measurements_timer(void)
-{
-  TCE0.CTRLB = TC_WGMODE_NORMAL_gc;
-  TCE0.CTRLA = TC_CLKSEL_DIV64_gc;
-  TCE0.INTCTRLA = TC_OVFINTLVL_LO_gc;
-  TCE0.PER = 31999;
-}
-
-// Wanneer de timer overloopt zal measurementsFlag op 1 gezet worden en zal er een meting gedaan worden.
-ISR(TCE0_OVF_vect){
-  measurementsFlag = 1;
+#ifdef DEBUG_SAMPLES
+  printf("%u,%d,%d,%d\n", samples[0].seq, samples[0].x, samples[0].y, samples[0].z);
+#endif
+  while (count > 0) {
+    // Alleen de interrupt haalt pakketten uit de rij, dus als er nu plek is, is die
+    // er ook bij nrfTxSend(). Bij een volle rij blijft het vakje van txCounts van het
+    // oudste pakket staan.
+    if (nrfTxBusy()) {
+      txDropped += count;
+      break;
+    }
+#ifdef TELEMETRY_DELTA
+    length = telemetry_encode_delta(samples, count, buffer, sizeof(buffer), &used);
+#else
+    length = telemetry_encode(samples, count, buffer, sizeof(buffer));
+    used = count;
+#endif
+    if (length == 0) {
+      break;
+    }
+    // Eerst het aantal, de interrupt van dit pakket kan direct na nrfTxSend() komen
+    txCounts[txCountIn] = used;
+    nrfTxSend(buffer, length);
+    txCountIn = (txCountIn + 1) % NRF_TX_FIFO_SIZE;
+    samples += used;
+    count -= used;
+  }
 }
 
 int main(void){   
@@ -153,25 +282,76 @@ int main(void){
   //Hier worden alle initialisaties gedaan.
   init_clock();
   init_stream(F_CPU);
+  timestamp_init();
   i2c_init(&TWIE, TWI_BAUD(F_CPU, BAUD_400K));
-  changeModeWake(&TWIE);
+  if (accel_init(&accelConfig) != ACCEL_OK) {
+    printf("accelerometer niet ingesteld\n");
+  }
+  sampler_init(accelConfig.rate_hz);
   nrf_init();
-  init_measurements_timer();
   clear_screen();
   
   // In deze structs worden alle waardes van de accelerometer opgeslagen.
   AccelerometerReadings rawAcceleration;
-  ACCOmgerekend accelarationG;
+  telemetry_sample_t batch[TELEMETRY_BATCH];
+  telemetry_sample_t sample;
+  telemetry_sample_t filtered;
+  filter_t filter;
+  deadband_t deadband;
+  uint8_t batchCount = 0;
+  uint8_t raw[ACC_BURST_LEN];
+  uint32_t rawTime;
+  uint16_t command;
+  uint32_t delivered;
 
+  filter_init(&filter, FILTER_MODE, FILTER_DECIMATE, FILTER_SHIFT);
+  deadband_init(&deadband, DEADBAND_THRESHOLD, DEADBAND_KEEPALIVE_MS * 1000UL);
   sei();
 
   while (1) { 
-    if(measurementsFlag){
-      measurementsFlag = 0;
+    // Elke meting wordt gestart door de data-ready interrupt van de accelerometer.
+    if(sampler_get(raw, &rawTime)){
+      readRegisterAccelerometer(raw, &rawAcceleration);
+      calculateAcceleration(&rawAcceleration, &sample);
+      sample.timestamp = rawTime;
+
+      // Alleen een gefilterde meting die genoeg veranderd is wordt verzonden. De
+      // metingen worden verzameld tot er TELEMETRY_BATCH in een pakket passen.
+      // Wordt een meting onderdrukt, dan gaat een half gevuld pakket meteen weg,
+      // zodat de laatste beweging niet blijft wachten.
+      if (filter_put(&filter, &sample, &filtered)) {
+        if (deadband_check(&deadband, &filtered)) {
+          batch[batchCount] = filtered;
+          batch[batchCount].seq = sequenceNumber++;
+          batchCount++;
+        } else if (batchCount > 0) {
+          nrfSend(batch, batchCount);
+          batchCount = 0;
+        }
+
+        if (batchCount == TELEMETRY_BATCH) {
+          nrfSend(batch, batchCount);
+          batchCount = 0;
+        }
+      }
+    }
 
-      readRegisterAccelerometer(&TWIE, &rawAcceleration);
-      calculateAcceleration(&rawAcceleration, &accelarationG);
-      nrfSend(accelarationG.x, accelarationG.y);
+    // Via de seriele poort: 's' print de tellers van de sampler, hoeveel metingen
+    // er verzonden en onderdrukt zijn en wat de radio heeft afgeleverd, 'c' wist
+    // de tellers van de sampler en de deadband.
+    command = uartF0_getc();
+    if (command == 's') {
+      sampler_print();
+      printf("deadband: verzonden=%lu onderdrukt=%lu\n", deadband.sent, deadband.suppressed);
+      cli();
+      delivered = txDelivered;
+      sei();
+      printf("radio: afgeleverd=%lu mislukt=%u gedropt=%u slave=%u\n", delivered,
+             txFailures, txDropped, slaveReceived);
+    } else if (command == 'c') {
+      sampler_reset_stats();
+      deadband.sent = 0;
+      deadband.suppressed = 0;
     }
   }
 }
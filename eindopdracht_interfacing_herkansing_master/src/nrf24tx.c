@@ -0,0 +1,250 @@
+/*!
+ *  \file    nrf24tx.c
+ *  \date    16-10-2026
+ *  \version 1.3
+ *  \brief   Interrupt driven, pipelined transmit for the Nordic NRF24L01p
+ */
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <stddef.h>
+#include "nrf24_pindef.h"
+#include "nrf24spiXM2.h"
+#include "nrf24L01.h"
+#include "nrf24tx.h"
+
+// The timer runs at F_CPU/64 = 500 kHz, 2 us per tick
+#define NRF_TX_US_PER_TICK  2
+// Margin on top of the retransmit time for settling and the air time
+#define NRF_TX_MARGIN_US    2000
+
+static volatile uint8_t pending = 0;    // payloads in the TX FIFO
+static uint16_t         timeoutTicks;
+static nrfTxCallback_t  txCallback = NULL;
+static nrfTxAckCallback_t txAckCallback = NULL;
+
+static void nrfTxStartTimer(void);
+static void nrfTxReport(uint8_t status);
+static uint8_t nrfTxInFifo(uint8_t limit);
+static void nrfTxComplete(void);
+static void nrfTxDrain(uint8_t status);
+static void nrfTxIdle(void);
+static void nrfTxReadAck(void);
+
+/*!
+ * \brief   Initialize the interrupt driven transmit
+ *
+ * \details Call this after the radio is configured (retries, pipes). The
+ *          radio is put in transmit mode and stays there. The timeout is
+ *          derived from the retransmit settings at this moment.
+ *
+ * \param   callback     Called with the result of every payload, may be NULL
+ * \param   ackCallback  Called with every acknowledge payload, may be NULL
+ */
+void nrfTxInit(nrfTxCallback_t callback, nrfTxAckCallback_t ackCallback)
+{
+  txCallback   = callback;
+  txAckCallback = ackCallback;
+  timeoutTicks = ((uint32_t) nrfGetMaxTimeout() + NRF_TX_MARGIN_US) / NRF_TX_US_PER_TICK;
+
+  NRF_TX_TIMER.CTRLA   = TC_CLKSEL_OFF_gc;
+  NRF_TX_TIMER.CTRLB   = TC_WGMODE_NORMAL_gc;
+  NRF_TX_TIMER.INTCTRLA = TC_OVFINTLVL_LO_gc;
+
+  nrfCE(NRF_DISABLE);
+  nrfWriteRegister(REG_CONFIG,
+      (nrfReadRegister(REG_CONFIG) | NRF_CONFIG_PWR_UP_bm) & ~NRF_CONFIG_PRIM_RX_bm);
+  nrfFlushRx();
+  nrfFlushTx();
+  nrfClearInterruptBits();
+}
+
+/*!
+ * \brief   Queue one payload for transmission
+ *
+ * \details The payload is written to the TX FIFO and CE is raised. The
+ *          function does not wait for the acknowledge.
+ *
+ * \param   buf  Pointer to the data to be sent
+ * \param   len  Number of bytes to be sent
+ *
+ * \return  1 if the payload is queued,
+ *          0 if the TX FIFO is full
+ */
+uint8_t nrfTxSend(const uint8_t *buf, uint8_t len)
+{
+  uint8_t sreg;
+
+  if (pending >= NRF_TX_FIFO_SIZE) {
+    return 0;
+  }
+
+  // The interrupt handlers use the SPI bus and the FIFO as well
+  sreg = SREG;
+  cli();
+
+  if (pending == 0) {
+    nrfTxStartTimer();
+  }
+  nrfWritePayload(buf, len, NRF_W_TX_PAYLOAD);
+  pending++;
+
+  // CE stays high while there are payloads, the radio settles by itself
+  nrfCE(NRF_ENABLE);
+
+  SREG = sreg;
+
+  return 1;
+}
+
+/*!
+ * \brief   Test whether the TX FIFO is full
+ *
+ * \return  1 if no payload can be queued, 0 if it can
+ */
+uint8_t nrfTxBusy(void)
+{
+  return pending >= NRF_TX_FIFO_SIZE;
+}
+
+/*!
+ * \brief   Number of payloads that are queued or in the air
+ *
+ * \return  0 up to NRF_TX_FIFO_SIZE
+ */
+uint8_t nrfTxPending(void)
+{
+  return pending;
+}
+
+// The timeout covers the payload at the head of the FIFO
+static void nrfTxStartTimer(void)
+{
+  NRF_TX_TIMER.CTRLA = TC_CLKSEL_OFF_gc;
+  NRF_TX_TIMER.CNT   = 0;
+  NRF_TX_TIMER.PER   = timeoutTicks;
+  NRF_TX_TIMER.INTFLAGS = TC0_OVFIF_bm;
+  NRF_TX_TIMER.CTRLA = TC_CLKSEL_DIV64_gc;
+}
+
+static void nrfTxReport(uint8_t status)
+{
+  if (txCallback != NULL) {
+    txCallback(status);
+  }
+}
+
+/*
+ * Payloads that are still in the TX FIFO; an acknowledged payload leaves
+ * the FIFO, a failing one stays at the head. The radio only tells whether
+ * the FIFO is empty or full, so one or two entries both read as two; the
+ * result is limited to limit, the most that can still be in the FIFO.
+ */
+static uint8_t nrfTxInFifo(uint8_t limit)
+{
+  uint8_t fifo = nrfReadRegister(REG_FIFO_STATUS);
+  uint8_t n;
+
+  if (fifo & NRF_FIFO_STATUS_TX_EMPTY_bm) {
+    n = 0;
+  } else if (fifo & NRF_FIFO_STATUS_TX_FULL_bm) {
+    n = NRF_TX_FIFO_SIZE;
+  } else {
+    n = NRF_TX_FIFO_SIZE - 1;
+  }
+
+  return (n < limit) ? n : limit;
+}
+
+/*
+ * At least the payload at the head of the FIFO is acknowledged. The IRQ
+ * line can cover more than one TX_DS when it is handled late, so every
+ * payload that has left the FIFO is done. With three pending and one or
+ * two left this counts one; the other is completed by the next TX_DS.
+ */
+static void nrfTxComplete(void)
+{
+  uint8_t done = pending - nrfTxInFifo(pending - 1);
+
+  while (done-- && pending) {
+    pending--;
+    nrfTxReport(NRF_TX_OK);
+  }
+
+  if (pending == 0) {
+    nrfTxIdle();
+  } else {
+    nrfTxStartTimer();
+  }
+}
+
+/*
+ * The head payload failed or timed out: drop the whole FIFO. Payloads that
+ * left the FIFO before it were acknowledged, their TX_DS was lost or taken
+ * together with another one.
+ */
+static void nrfTxDrain(uint8_t status)
+{
+  uint8_t inFifo = nrfTxInFifo(pending);
+
+  nrfCE(NRF_DISABLE);
+  nrfFlushTx();
+  while (pending > inFifo) {
+    pending--;
+    nrfTxReport(NRF_TX_OK);
+  }
+  if (pending) {
+    pending--;
+    nrfTxReport(status);
+  }
+  while (pending) {
+    pending--;
+    nrfTxReport(NRF_TX_FLUSHED);
+  }
+  nrfTxIdle();
+}
+
+// Nothing left to send: standby until the next payload
+static void nrfTxIdle(void)
+{
+  NRF_TX_TIMER.CTRLA = TC_CLKSEL_OFF_gc;
+  nrfCE(NRF_DISABLE);
+}
+
+static void nrfTxReadAck(void)
+{
+  uint8_t buf[NRF_MAX_PAYLOAD_SIZE];
+  uint8_t len = nrfGetDynamicPayloadSize();
+
+  if (len > NRF_MAX_PAYLOAD_SIZE) {
+    nrfFlushRx();     // corrupt length, see datasheet
+    return;
+  }
+  nrfRead(buf, len);
+  if (txAckCallback != NULL) {
+    txAckCallback(buf, len);
+  }
+}
+
+ISR(NRF24_IRQ_VEC)
+{
+  uint8_t tx_ds, max_rt, rx_dr;
+
+  nrfWhatHappened(&tx_ds, &max_rt, &rx_dr);
+
+  if (rx_dr) {
+    nrfTxReadAck();
+  }
+  if (pending && tx_ds) {
+    nrfTxComplete();
+  }
+  if (pending && max_rt) {
+    nrfTxDrain(NRF_TX_MAX_RT);
+  }
+}
+
+ISR(NRF_TX_TIMER_VEC)
+{
+  if (pending) {
+    nrfTxDrain(NRF_TX_TIMEOUT);
+  }
+}
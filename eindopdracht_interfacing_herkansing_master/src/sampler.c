@@ -0,0 +1,138 @@
+/*!
+ * \file    sampler.c
+ * \brief   Accelerometer sampling driven by its data-ready interrupt, see
+ *          sampler.h.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#include "sampler.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "i2c_async.h"
+#include "timestamp.h"
+#include "HVA_accel.h"
+
+// Double buffer: the read fills buffer sampler_back, sampler_get() takes the other one
+static uint8_t sampler_buf[2][ACC_BURST_LEN];
+static uint32_t sampler_time[2];
+static volatile uint8_t sampler_back = 0;
+static volatile uint8_t sampler_ready = 0;
+
+static uint16_t sampler_rate_hz;
+static uint16_t sampler_period;     // microseconds between two samples
+static uint32_t sampler_edge;       // time of the previous edge
+static uint8_t sampler_started = 0;
+static volatile sampler_stats_t sampler_stats;
+
+/* rate_hz is the data rate the accelerometer was set to */
+void sampler_init(uint16_t rate_hz)
+{
+    sampler_rate_hz = rate_hz;
+    sampler_period = 1000000UL / rate_hz;
+
+    SAMPLER_INT_PORT.DIRCLR = SAMPLER_INT_PIN;
+    SAMPLER_INT_PORT.SAMPLER_INT_CTRL = PORT_ISC_FALLING_gc;
+    SAMPLER_INT_PORT.INT0MASK |= SAMPLER_INT_PIN;
+    SAMPLER_INT_PORT.INTCTRL =
+        (SAMPLER_INT_PORT.INTCTRL & ~PORT_INT0LVL_gm) | PORT_INT0LVL_LO_gc;
+    PMIC.CTRL |= PMIC_LOLVLEN_bm;
+}
+
+/*
+ * Copy the newest sample (ACC_BURST_LEN bytes) and the time of its
+ * data-ready edge. Returns 0 when there is no new sample.
+ */
+uint8_t sampler_get(uint8_t *raw, uint32_t *timestamp)
+{
+    uint8_t front;
+    uint8_t sreg = SREG;
+
+    if (!sampler_ready) {
+        return 0;
+    }
+
+    cli();
+    front = sampler_back ^ 1;
+    memcpy(raw, sampler_buf[front], ACC_BURST_LEN);
+    *timestamp = sampler_time[front];
+    sampler_ready = 0;
+    SREG = sreg;
+
+    return 1;
+}
+
+void sampler_get_stats(sampler_stats_t *stats)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    *stats = sampler_stats;
+    SREG = sreg;
+}
+
+void sampler_reset_stats(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    memset((void *) &sampler_stats, 0, sizeof(sampler_stats));
+    SREG = sreg;
+}
+
+// Print the counters on the serial port (stdout is serialF0)
+void sampler_print(void)
+{
+    sampler_stats_t stats;
+
+    sampler_get_stats(&stats);
+    printf("sampler: %u Hz samples=%lu dropped=%u missed=%u duplicate=%u errors=%u\n",
+           sampler_rate_hz, stats.samples, stats.dropped, stats.missed,
+           stats.duplicate, stats.errors);
+}
+
+// Called from the TWI interrupt when the burst read is done
+static void sampler_read_done(uint8_t status)
+{
+    if (status != I2C_STATUS_OK) {
+        sampler_stats.errors++;
+        return;
+    }
+
+    if (sampler_ready) {
+        sampler_stats.dropped++;
+    }
+    sampler_back ^= 1;
+    sampler_ready = 1;
+    sampler_stats.samples++;
+}
+
+ISR(SAMPLER_INT_VEC)
+{
+    uint32_t now = timestamp_now();
+    uint32_t gap = now - sampler_edge;
+
+    if (sampler_started) {
+        if (gap < sampler_period / 2) {
+            sampler_stats.duplicate++;
+            return;
+        }
+        if (gap > sampler_period + sampler_period / 2) {
+            sampler_stats.missed += (gap + sampler_period / 2) / sampler_period - 1;
+        }
+    }
+    sampler_edge = now;
+    sampler_started = 1;
+
+    if (i2c_async_busy()) {
+        sampler_stats.dropped++;
+        return;
+    }
+    sampler_time[sampler_back] = now;
+    if (i2c_async_read(ACC_ID, XOUT_EX_L, sampler_buf[sampler_back], ACC_BURST_LEN,
+                       sampler_read_done) != I2C_STATUS_OK) {
+        sampler_stats.errors++;
+    }
+}
@@ -0,0 +1,50 @@
+/*!
+ * \file    timestamp.c
+ * \brief   Free-running 32 bit timestamp in microseconds, built from two
+ *          cascaded 16 bit timers. See timestamp.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "timestamp.h"
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+void timestamp_init(void)
+{
+    TIMESTAMP_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+    TIMESTAMP_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+
+    TIMESTAMP_EV_CLK = EVSYS_CHMUX_PRESCALER_32_gc;
+    TIMESTAMP_EV_OVF = EVSYS_CHMUX_TCC0_OVF_gc;
+
+    TIMESTAMP_LOW.CTRLB = TC_WGMODE_NORMAL_gc;
+    TIMESTAMP_LOW.PER = 0xFFFF;
+    TIMESTAMP_LOW.CNT = 0;
+    TIMESTAMP_HIGH.CTRLB = TC_WGMODE_NORMAL_gc;
+    TIMESTAMP_HIGH.PER = 0xFFFF;
+    TIMESTAMP_HIGH.CNT = 0;
+
+    TIMESTAMP_HIGH.CTRLA = TC_CLKSEL_EVCH1_gc;
+    TIMESTAMP_LOW.CTRLA = TC_CLKSEL_EVCH0_gc;
+}
+
+/*
+ * The high word is read before and after the low word; if it changed, the
+ * low word overflowed in between and is read again. Interrupts are off
+ * because the 16 bit reads share the TEMP register with interrupt code.
+ */
+uint32_t timestamp_now(void)
+{
+    uint16_t high, low;
+    uint8_t sreg = SREG;
+
+    cli();
+    do {
+        high = TIMESTAMP_HIGH.CNT;
+        low = TIMESTAMP_LOW.CNT;
+    } while (high != TIMESTAMP_HIGH.CNT);
+    SREG = sreg;
+
+    return ((uint32_t) high << 16) | low;
+}
@@ -0,0 +1,252 @@
+/*!
+ * \file    filter_test.c
+ * \brief   Tests of the decimating filter of the master
+ *          (eindopdracht_interfacing_herkansing_master/src/filter.c) on the
+ *          host, against a reference in double precision: the moving
+ *          average has to round half away from zero, the IIR has to stay
+ *          within 1 LSB of Q4.11 of the exact low-pass at every sample.
+ *
+ *          Usage: filter_test <case>
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "filter.h"
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+#define IIR_SAMPLES     4000    // a full scale step settles with shift 8 in about 3000
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(void);
+} filter_case_t;
+
+static uint32_t failures;
+static uint32_t seed = 1;
+
+static void check(int ok, const char *what, int line)
+{
+    if (!ok) {
+        printf("line %d: %s\n", line, what);
+        failures++;
+    }
+}
+
+static int16_t random_value(int16_t range)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (int16_t) ((int32_t) ((seed >> 8) % (2 * (uint32_t) range + 1)) - range);
+}
+
+static telemetry_sample_t make_sample(int16_t x, int16_t y, int16_t z, uint32_t timestamp)
+{
+    telemetry_sample_t s;
+
+    memset(&s, 0, sizeof(s));
+    s.x = x;
+    s.y = y;
+    s.z = z;
+    s.timestamp = timestamp;
+    return s;
+}
+
+/*
+ * Put a block of decimate samples with x = values[i], y = -values[i] and
+ * z = 0 in the filter; checks that only the last one gives a sample.
+ */
+static uint8_t put_block(filter_t *f, const int16_t *values, uint8_t decimate,
+                         telemetry_sample_t *out)
+{
+    telemetry_sample_t in;
+    uint8_t i, done = 0;
+
+    for (i = 0; i < decimate; i++) {
+        in = make_sample(values[i], (int16_t) -values[i], 0, 1000 + i);
+        done = filter_put(f, &in, out);
+        if (i + 1 < decimate && done) {
+            return 0;
+        }
+    }
+    return done;
+}
+
+/* The mean of the block, rounded half away from zero like round() */
+static int16_t reference_mean(const int16_t *values, uint8_t decimate, int8_t sign)
+{
+    double sum = 0;
+    uint8_t i;
+
+    for (i = 0; i < decimate; i++) {
+        sum += sign * (double) values[i];
+    }
+    return (int16_t) round(sum / decimate);
+}
+
+static uint32_t test_ma(void)
+{
+    /* Means that end in exactly one half, on both sides of zero */
+    static const int16_t halves[][4] = {
+        { 1, 0, 0, 0 }, { -1, 0, 0, 0 }, { 3, 0, 0, 0 }, { -3, 0, 0, 0 },
+        { 2, 0, 0, 0 }, { -2, 0, 0, 0 }, { 1, 2, 0, 0 }, { -1, -2, 0, 0 },
+    };
+    static const int16_t extremes[] = { INT16_MAX, INT16_MAX, INT16_MAX, INT16_MAX,
+                                        INT16_MAX, INT16_MAX, INT16_MAX, INT16_MAX };
+    static const int16_t lowest[] = { INT16_MIN + 1, INT16_MIN + 1, INT16_MIN + 1, INT16_MIN + 1 };
+    int16_t values[255];
+    telemetry_sample_t out;
+    filter_t f;
+    uint8_t decimate, i, j;
+
+    /* decimate 2 gives x.5 for an odd sum, decimate 4 gives x.5 for sum 2 mod 4 */
+    for (i = 0; i < sizeof(halves) / sizeof(halves[0]); i++) {
+        decimate = (i < 4) ? 2 : 4;
+        filter_init(&f, FILTER_MA, decimate, 0);
+        CHECK(put_block(&f, halves[i], decimate, &out));
+        CHECK(out.x == reference_mean(halves[i], decimate, 1));
+        CHECK(out.y == reference_mean(halves[i], decimate, -1));
+        CHECK(out.z == 0);
+    }
+    filter_init(&f, FILTER_MA, 2, 0);
+    put_block(&f, halves[0], 2, &out);
+    CHECK(out.x == 1 && out.y == -1);       /* 0.5 and -0.5 */
+
+    /* The sum of a full block of extremes does not overflow */
+    filter_init(&f, FILTER_MA, 8, 0);
+    CHECK(put_block(&f, extremes, 8, &out));
+    CHECK(out.x == INT16_MAX && out.y == -INT16_MAX);
+    filter_init(&f, FILTER_MA, 4, 0);
+    CHECK(put_block(&f, lowest, 4, &out));
+    CHECK(out.x == INT16_MIN + 1 && out.y == INT16_MAX);
+
+    /* Random blocks for every block length up to the largest one */
+    for (decimate = 1; decimate != 0; decimate++) {
+        filter_init(&f, FILTER_MA, decimate, 0);
+        for (j = 0; j < 3; j++) {
+            for (i = 0; i < decimate; i++) {
+                values[i] = random_value(16 * TELEMETRY_ONE_G - 1);
+            }
+            CHECK(put_block(&f, values, decimate, &out));
+            CHECK(out.x == reference_mean(values, decimate, 1));
+            CHECK(out.y == reference_mean(values, decimate, -1));
+            CHECK(out.timestamp == 1000U + decimate - 1);
+        }
+        if (failures) {
+            printf("decimate %u\n", decimate);
+            break;
+        }
+    }
+
+    return failures;
+}
+
+/*
+ * Run the IIR over the signal of next() and compare every output with
+ * y += (x - y) / 2^shift in double precision, the first sample sets y.
+ * Returns the largest difference in LSB and the last output in last.
+ */
+static double run_iir(uint8_t shift, int16_t (*next)(uint16_t n), int16_t *last)
+{
+    telemetry_sample_t in, out;
+    filter_t f;
+    double y = 0, err, worst = 0;
+    uint16_t n;
+    int16_t x;
+
+    filter_init(&f, FILTER_IIR, 1, shift);
+    for (n = 0; n < IIR_SAMPLES; n++) {
+        x = next(n);
+        y = (n == 0) ? x : y + (x - y) / (double) (1 << shift);
+        in = make_sample(x, (int16_t) -x, x, n);
+        if (!filter_put(&f, &in, &out)) {
+            return 1e9;
+        }
+        err = fabs(out.x - y);
+        if (err > worst) worst = err;
+        err = fabs(out.y + y);
+        if (err > worst) worst = err;
+    }
+    *last = out.x;
+
+    return worst;
+}
+
+static int16_t step_up(uint16_t n)      { return (n == 0) ? 0 : TELEMETRY_ONE_G; }
+static int16_t step_down(uint16_t n)    { return (n == 0) ? 0 : -3 * TELEMETRY_ONE_G - 7; }
+static int16_t full_scale(uint16_t n)   { return (n == 0) ? INT16_MIN + 1 : INT16_MAX; }
+static int16_t noise(uint16_t n)        { (void) n; return random_value(4 * TELEMETRY_ONE_G); }
+
+static uint32_t test_iir(void)
+{
+    static int16_t (*const signals[])(uint16_t n) = { step_up, step_down, full_scale, noise };
+    static const int16_t final[] = { TELEMETRY_ONE_G, -3 * TELEMETRY_ONE_G - 7, INT16_MAX, 0 };
+    double worst;
+    int16_t last;
+    uint8_t shift, i;
+
+    for (shift = 0; shift <= FILTER_MAX_SHIFT; shift++) {
+        for (i = 0; i < sizeof(signals) / sizeof(signals[0]); i++) {
+            worst = run_iir(shift, signals[i], &last);
+            if (worst > 1.0) {
+                printf("shift %u signal %u: %.3f LSB off\n", shift, i, worst);
+                failures++;
+            }
+            /* A step settles within 1 LSB of its end value */
+            if (signals[i] != noise && (last < final[i] - 1 || last > final[i] + 1)) {
+                printf("shift %u signal %u: settles at %d, not %d\n", shift, i, last, final[i]);
+                failures++;
+            }
+        }
+    }
+
+    return failures;
+}
+
+/* Without a filter every decimate-th sample is passed on */
+static uint32_t test_none(void)
+{
+    static const int16_t values[] = { 5, -6, 7 };
+    telemetry_sample_t out;
+    filter_t f;
+
+    filter_init(&f, FILTER_NONE, 3, 0);
+    CHECK(put_block(&f, values, 3, &out));
+    CHECK(out.x == 7 && out.y == -7 && out.timestamp == 1002);
+
+    /* decimate 0 is 1, a shift over the maximum is the maximum */
+    filter_init(&f, FILTER_IIR, 0, FILTER_MAX_SHIFT + 5);
+    CHECK(f.decimate == 1 && f.shift == FILTER_MAX_SHIFT);
+
+    return failures;
+}
+
+static const filter_case_t cases[] = {
+    { "ma", test_ma },
+    { "iir", test_iir },
+    { "none", test_none },
+};
+
+int main(int argc, char *argv[])
+{
+    uint32_t failed;
+    uint8_t i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: filter_test <case>\n");
+        return 2;
+    }
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(argv[1], cases[i].name) == 0) {
+            failed = cases[i].run();
+            printf("%s: %s\n", cases[i].name, failed == 0 ? "ok" : "FAILED");
+            return failed == 0 ? 0 : 1;
+        }
+    }
+
+    fprintf(stderr, "unknown case %s\n", argv[1]);
+    return 2;
+}
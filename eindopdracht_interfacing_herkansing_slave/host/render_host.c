@@ -0,0 +1,80 @@
+/*!
+ * \file    render_host.c
+ * \brief   Host build of the slave renderer. Sets up the same scene as
+ *          main.c, but with ucg_com_host_cb instead of ucg_com_xmega_cb,
+ *          moves the balls for a number of frames with a fixed tilt and
+ *          prints the display bus statistics per frame.
+ *
+ *          Usage: render_host [frames] [output.ppm]
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "ucglib_host.h"
+#include "ucglib_xmega.h"
+#include "moving_discs.h"
+#include "balls.h"
+#include "tiles.h"
+
+static void print_stats(const char *label)
+{
+    const ucg_host_stats_t *s = ucg_host_get_stats();
+
+    printf("%-8s bytes=%7lu cmd=%6lu data=%7lu pixels=%6lu cs=%5lu windows=%5lu\n",
+           label,
+           (unsigned long) s->bytes, (unsigned long) s->cmd_bytes,
+           (unsigned long) s->data_bytes, (unsigned long) s->pixels,
+           (unsigned long) s->cs_edges, (unsigned long) s->windows);
+}
+
+int main(int argc, char *argv[])
+{
+    int frames = (argc > 1) ? atoi(argv[1]) : 10;
+    const char *ppm = (argc > 2) ? argv[2] : NULL;
+    char label[16];
+    ucg_t ucg;
+
+    ucg_Init(&ucg, UCGLIB_DEV_ST7735, UCGLIB_EXT_ST7735, ucg_com_host_cb);
+    ucg_SetFontMode(&ucg, UCG_FONT_MODE_TRANSPARENT);
+    ucg_ClearScreen(&ucg);
+    ucg_SetFont(&ucg, ucg_font_8x13_mr);
+    ucg_SetColor(&ucg, 0, 255, 255, 0);
+    ucg_SetRotate90(&ucg);
+    print_stats("init");
+
+    color_t c1, c2, c3, c4;
+    md_set_color(&c1, ball1.red, ball1.green, ball1.blue);
+    md_set_color(&c2, ball2.red, ball2.green, ball2.blue);
+    md_set_color(&c3, ball3.red, ball3.green, ball3.blue);
+    md_set_color(&c4, ball4.red, ball4.green, ball4.blue);
+
+    disc_t disc1, disc2, disc3, disc4;
+    md_init_disc(&disc1, &ucg, 1, ball1.size, &c1);
+    md_init_disc(&disc2, &ucg, 2, ball2.size, &c2);
+    md_init_disc(&disc3, &ucg, 3, ball3.size, &c3);
+    md_init_disc(&disc4, &ucg, 4, ball4.size, &c4);
+    md_set_disc_position(&disc1, 25, 75);
+    md_set_disc_position(&disc2, X_LINES, 95);
+    md_set_disc_position(&disc3, 0, 115);
+    md_set_disc_position(&disc4, 50, 50);
+
+    /* a small constant tilt: every ball moves by one pixel per frame */
+    for (int i = 0; i < frames; i++) {
+        ucg_host_reset_stats();
+        md_move_disc(&disc1, 1, 0);
+        md_move_disc(&disc2, 1, 0);
+        md_move_disc(&disc3, 0, 1);
+        md_move_disc(&disc4, 1, 1);
+        tiles_flush(&ucg);
+        snprintf(label, sizeof(label), "frame%d", i);
+        print_stats(label);
+    }
+
+    if (ppm != NULL && ucg_host_write_ppm(ppm) != 0) {
+        fprintf(stderr, "cannot write %s\n", ppm);
+        return 1;
+    }
+
+    return 0;
+}
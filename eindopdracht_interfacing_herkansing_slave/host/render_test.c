@@ -0,0 +1,407 @@
+/*!
+ * \file    render_test.c
+ * \brief   Framebuffer tests of the slave renderer on the host. Every case
+ *          draws the same picture twice on the emulated ST7735: once
+ *          through the path that is used on the XMEGA and once through a
+ *          plain reference path (a cleared screen and ucg_DrawDisc per
+ *          disc, from bottom to top). The case fails on any pixel that
+ *          differs.
+ *
+ *          Usage: render_test <case>
+ * \version 1.2
+ * \date    16-10-2026
+ */
+#include <stdio.h>
+#include <string.h>
+#include "ucglib_host.h"
+#include "ucglib_xmega.h"
+#include "spi_dma.h"
+#include "spi_dma_host.h"
+#include "moving_discs.h"
+#include "balls.h"
+#include "sprite.h"
+#include "tiles.h"
+
+#define SCENE_FRAMES    400
+#define SCENE_MAX_MOVE  3   // largest move per frame in pixels
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(void);
+} render_case_t;
+
+static ucg_t ucg;
+static ucg_com_fnptr com_cb = ucg_com_host_cb;
+static ucg_host_fb_t expected;
+static color_t colors[4];
+static disc_t discs[4];
+static uint32_t seed = 1;
+
+static int16_t random_move(void)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (int16_t) ((seed >> 16) % (2 * MD_FIX(SCENE_MAX_MOVE) + 1)) - MD_FIX(SCENE_MAX_MOVE);
+}
+
+static void init_display(void)
+{
+    ucg_Init(&ucg, UCGLIB_DEV_ST7735, UCGLIB_EXT_ST7735, com_cb);
+    ucg_SetFontMode(&ucg, UCG_FONT_MODE_TRANSPARENT);
+    ucg_ClearScreen(&ucg);
+    ucg_SetRotate90(&ucg);
+}
+
+/* The balls of main.c at their start positions */
+static void init_scene(void)
+{
+    static const ball *balls[4] = { &ball1, &ball2, &ball3, &ball4 };
+    uint8_t i;
+
+    init_display();
+    for (i = 0; i < 4; i++) {
+        md_set_color(&colors[i], balls[i]->red, balls[i]->green, balls[i]->blue);
+        md_init_disc(&discs[i], &ucg, i + 1, balls[i]->size, &colors[i]);
+    }
+    md_set_disc_position(&discs[0], 25, 75);
+    md_set_disc_position(&discs[1], X_LINES, 95);
+    md_set_disc_position(&discs[2], 0, 115);
+    md_set_disc_position(&discs[3], 50, 50);
+}
+
+/* Reference: clear the screen and draw every visible disc, bottom first */
+static void draw_reference(void)
+{
+    disc_t *disc;
+    uint8_t z;
+
+    ucg_ClearScreen(&ucg);
+    for (z = 0; (disc = md_get_disc(z)) != NULL; z++) {
+        if (disc->visible) {
+            ucg_SetColor(&ucg, 0, disc->color->red, disc->color->green, disc->color->blue);
+            ucg_DrawDisc(&ucg, disc->x, disc->y, disc->rad, UCG_DRAW_ALL);
+        }
+    }
+}
+
+/*
+ * Move the balls with random sub-pixel steps, so they wrap around the
+ * edges and overlap each other, and compare every frame with the
+ * reference. Returns the number of differing pixels of the first frame
+ * that differs.
+ */
+static uint32_t run_scene(void)
+{
+    uint32_t diff;
+    uint16_t frame;
+    uint8_t i;
+
+    for (frame = 0; frame < SCENE_FRAMES; frame++) {
+        for (i = 0; i < 4; i++) {
+            md_move_disc_fixed(&discs[i], random_move(), random_move());
+        }
+        tiles_flush(&ucg);
+        spi_dma_wait();
+
+        ucg_host_copy_framebuffer(&expected);
+        draw_reference();
+        spi_dma_wait();
+        diff = ucg_host_diff_framebuffer(&expected);
+        if (diff != 0) {
+            printf("frame %u: %lu pixels differ\n", frame, (unsigned long) diff);
+            return diff;
+        }
+    }
+
+    return 0;
+}
+
+/* The game as it runs on the XMEGA */
+static uint32_t test_scene(void)
+{
+    init_scene();
+    return run_scene();
+}
+
+/*
+ * The game through ucg_com_xmega_cb and the DMA mock of spi_dma_host.c.
+ * Fails when the com callback changes a line or writes SPI DATA while a
+ * DMA transfer is queued, or when the blit of one tile has to wait for a
+ * free DMA buffer.
+ */
+static uint32_t test_dma(void)
+{
+    static uint8_t tile[TILE_W * TILE_H * TILE_BPP];
+    const spi_dma_host_stats_t *s = spi_dma_host_get_stats();
+    uint32_t diff;
+
+    com_cb = ucg_com_xmega_cb;
+    init_scene();
+    spi_dma_host_reset_stats();
+    diff = run_scene();
+    printf("transfers=%lu overlapped=%lu blocked=%lu violations=%lu\n",
+           (unsigned long) s->transfers, (unsigned long) s->overlapped,
+           (unsigned long) s->blocked, (unsigned long) s->violations);
+
+    spi_dma_wait();
+    spi_dma_host_reset_stats();
+    if (!ucg_DrawNativeBlit(&ucg, 0, 0, TILE_W, TILE_H, tile) || s->blocked != 0) {
+        printf("tile blit: %lu of %lu transfers blocked\n",
+               (unsigned long) s->blocked, (unsigned long) s->transfers);
+        diff++;
+    }
+    spi_dma_wait();
+
+    return diff + s->violations;
+}
+
+/*
+ * The disc of the octant midpoint algorithm that ucg_DrawDisc used before
+ * the span cache: a vertical line through every point of the circle.
+ */
+static void draw_octant_disc(ucg_int_t x0, ucg_int_t y0, ucg_int_t rad)
+{
+    ucg_int_t f = 1 - rad, ddF_x = 1, ddF_y = -2 * rad, x = 0, y = rad;
+
+    for (;;) {
+        ucg_DrawVLine(&ucg, x0 + x, y0 - y, 2 * y + 1);
+        ucg_DrawVLine(&ucg, x0 - x, y0 - y, 2 * y + 1);
+        ucg_DrawVLine(&ucg, x0 + y, y0 - x, 2 * x + 1);
+        ucg_DrawVLine(&ucg, x0 - y, y0 - x, 2 * x + 1);
+        if (x >= y) {
+            break;
+        }
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+    }
+}
+
+/* ucg_DrawDisc from the span cache against the octant disc, for every cached radius */
+static uint32_t test_disc(void)
+{
+    uint32_t diff;
+    ucg_int_t rad;
+
+    init_display();
+    for (rad = 0; rad <= UCG_DISC_CACHE_MAX_RAD; rad++) {
+        ucg_ClearScreen(&ucg);
+        ucg_SetColor(&ucg, 0, 255, 255, 255);
+        ucg_DrawDisc(&ucg, 40, 60, rad, UCG_DRAW_ALL);
+        ucg_DrawDisc(&ucg, 2, 3, rad, UCG_DRAW_ALL);     /* clipped at the edge */
+        ucg_host_copy_framebuffer(&expected);
+
+        ucg_ClearScreen(&ucg);
+        ucg_SetColor(&ucg, 0, 255, 255, 255);
+        draw_octant_disc(40, 60, rad);
+        draw_octant_disc(2, 3, rad);
+        diff = ucg_host_diff_framebuffer(&expected);
+        if (diff != 0) {
+            printf("radius %d: %lu pixels differ\n", rad, (unsigned long) diff);
+            return diff;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * ucg_DrawDiscInBox against a black box with ucg_DrawDisc on top, in
+ * every rotation, so every direction of the blit window is used. The
+ * boxes at the edge are clipped and take the line by line fallback.
+ */
+static uint32_t test_disc_box(void)
+{
+    static void (*const rotate[4])(ucg_t *ucg) = {
+        ucg_UndoRotate, ucg_SetRotate90, ucg_SetRotate180, ucg_SetRotate270
+    };
+    static const int16_t boxes[][4] = {     /* disc x, y and move dx, dy */
+        { 40, 50, 0, 0 }, { 40, 50, 5, -3 }, { 60, 30, -8, 8 },
+        { 3, 4, 6, 2 }, { 120, 100, 8, 8 },
+    };
+    static const ucg_int_t radii[] = { 6, 8, 10, UCG_DISC_CACHE_MAX_RAD };
+    ucg_int_t x, y, rad, bx, by, w, h;
+    uint32_t diff;
+    uint8_t r, b, i;
+
+    init_display();
+    for (r = 0; r < 4; r++) {
+        rotate[r](&ucg);
+        for (b = 0; b < sizeof(boxes) / sizeof(boxes[0]); b++) {
+            for (i = 0; i < sizeof(radii) / sizeof(radii[0]); i++) {
+                rad = radii[i];
+                x = boxes[b][0];
+                y = boxes[b][1];
+                bx = (boxes[b][2] < 0 ? x + boxes[b][2] : x) - rad;
+                by = (boxes[b][3] < 0 ? y + boxes[b][3] : y) - rad;
+                w = 2 * rad + 1 + (boxes[b][2] < 0 ? -boxes[b][2] : boxes[b][2]);
+                h = 2 * rad + 1 + (boxes[b][3] < 0 ? -boxes[b][3] : boxes[b][3]);
+
+                ucg_SetColor(&ucg, 0, 255, 255, 255);
+                ucg_DrawBox(&ucg, 0, 0, ucg_GetWidth(&ucg), ucg_GetHeight(&ucg));
+                ucg_SetColor(&ucg, 0, 255, 0, 0);
+                ucg_SetColor(&ucg, 1, 0, 0, 0);
+                if (ucg_DrawDiscInBox(&ucg, x, y, rad, bx, by, w, h) == 0) {
+                    printf("rotation %u box %u radius %d: not drawn\n", r, b, rad);
+                    return 1;
+                }
+                ucg_host_copy_framebuffer(&expected);
+
+                ucg_SetColor(&ucg, 0, 255, 255, 255);
+                ucg_DrawBox(&ucg, 0, 0, ucg_GetWidth(&ucg), ucg_GetHeight(&ucg));
+                ucg_SetColor(&ucg, 0, 0, 0, 0);
+                ucg_DrawBox(&ucg, bx, by, w, h);
+                ucg_SetColor(&ucg, 0, 255, 0, 0);
+                ucg_DrawDisc(&ucg, x, y, rad, UCG_DRAW_ALL);
+                diff = ucg_host_diff_framebuffer(&expected);
+                if (diff != 0) {
+                    printf("rotation %u box %u radius %d: %lu pixels differ\n",
+                           r, b, rad, (unsigned long) diff);
+                    return diff;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* The scene without sprites, so every move goes through the tiles or the compositor */
+static uint32_t test_no_sprites(void)
+{
+    uint8_t i;
+
+    init_scene();
+    for (i = 0; i < 4; i++) {
+        discs[i].sprite = NULL;
+    }
+    return run_scene();
+}
+
+/*
+ * A clip box through the dirty areas, so their blits are refused and
+ * tiles_flush has to draw them line by line. The reference is drawn inside
+ * the clip box, then a moved area is painted white; the flush has to
+ * repaint it.
+ */
+static uint32_t test_tiles_clip(void)
+{
+    disc_t *disc;
+    uint8_t i;
+
+    init_scene();
+    for (i = 0; i < 4; i++) {
+        discs[i].sprite = NULL;
+    }
+    md_set_disc_position(&discs[0], 11, 30);
+    md_set_disc_position(&discs[1], 20, 38);
+    md_set_disc_position(&discs[2], 90, 60);
+    md_set_disc_position(&discs[3], 130, 100);
+    for (i = 0; i < 4; i++) {
+        md_move_disc(&discs[i], 0, 0);
+    }
+    tiles_flush(&ucg);
+    spi_dma_wait();
+
+    md_move_disc(&discs[0], -1, 2);
+    md_move_disc(&discs[1], 1, -3);
+    ucg_SetClipRange(&ucg, 0, 0, 12, Y_LINES);
+
+    ucg_SetColor(&ucg, 0, 0, 0, 0);
+    ucg_DrawBox(&ucg, 0, 0, X_LINES, Y_LINES);
+    for (i = 0; (disc = md_get_disc(i)) != NULL; i++) {
+        ucg_SetColor(&ucg, 0, disc->color->red, disc->color->green, disc->color->blue);
+        ucg_DrawDisc(&ucg, disc->x, disc->y, disc->rad, UCG_DRAW_ALL);
+    }
+    spi_dma_wait();
+    ucg_host_copy_framebuffer(&expected);
+
+    /* Inside the old and the new box of disc 0 */
+    ucg_SetColor(&ucg, 0, 255, 255, 255);
+    ucg_DrawBox(&ucg, 3, 24, 9, 15);
+    tiles_flush(&ucg);
+    spi_dma_wait();
+    ucg_SetMaxClipRange(&ucg);
+
+    return ucg_host_diff_framebuffer(&expected);
+}
+
+/*
+ * Every disc up to SPRITE_MAX_RAD has a sprite, and an isolated move is
+ * blitted from it in one address window instead of marking tiles
+ */
+static uint32_t test_sprite(void)
+{
+    const ucg_host_stats_t *s = ucg_host_get_stats();
+    uint32_t windows;
+    uint8_t i;
+
+    printf("sprite RAM: %u bytes\n", (unsigned) SPRITE_RAM_BYTES);
+    init_scene();
+    for (i = 0; i < 4; i++) {
+        if ((discs[i].sprite != NULL) != (discs[i].rad <= SPRITE_MAX_RAD)) {
+            printf("disc %u: radius %d, sprite %p\n", i, discs[i].rad, (void *) discs[i].sprite);
+            return 1;
+        }
+    }
+
+    /* Disc 2 alone in the middle of the screen; the others are far away */
+    md_set_disc_position(&discs[0], 10, 10);
+    md_set_disc_position(&discs[1], 80, 64);
+    md_set_disc_position(&discs[2], 150, 10);
+    md_set_disc_position(&discs[3], 20, 100);
+    for (i = 0; i < 4; i++) {
+        md_move_disc(&discs[i], 0, 0);
+    }
+    tiles_flush(&ucg);
+    spi_dma_wait();
+
+    ucg_host_reset_stats();
+    md_move_disc(&discs[1], 2, -1);
+    windows = s->windows;
+    tiles_flush(&ucg);
+    spi_dma_wait();
+    if (windows != 1 || s->windows != 1) {
+        printf("move: %lu windows, %lu after the flush\n",
+               (unsigned long) windows, (unsigned long) s->windows);
+        return 1;
+    }
+
+    return run_scene();
+}
+
+static const render_case_t cases[] = {
+    { "scene", test_scene },
+    { "dma", test_dma },
+    { "disc", test_disc },
+    { "disc_box", test_disc_box },
+    { "no_sprites", test_no_sprites },
+    { "sprite", test_sprite },
+    { "tiles_clip", test_tiles_clip },
+};
+
+int main(int argc, char *argv[])
+{
+    uint32_t diff;
+    uint8_t i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: render_test <case>\n");
+        return 2;
+    }
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(argv[1], cases[i].name) == 0) {
+            diff = cases[i].run();
+            printf("%s: %s\n", cases[i].name, diff == 0 ? "ok" : "FAILED");
+            return diff == 0 ? 0 : 1;
+        }
+    }
+
+    fprintf(stderr, "unknown case %s\n", argv[1]);
+    return 2;
+}
@@ -0,0 +1,198 @@
+/*!
+ * \file    spi_bench.c
+ * \brief   Throughput of spi_write_block() of src/spi.c on the host, in
+ *          bytes per emulated CPU cycle for several block sizes.
+ *
+ *          The real spi.c is compiled against stub/avr/io.h, where every
+ *          access to SPID calls spi_host_access(). The emulation below
+ *          counts SPI_BENCH_ACCESS_CYCLES for each access and shifts a
+ *          byte out in 8 SPI clocks of the divider set in CTRL (16 cycles
+ *          with DIV4 and CLK2X). The other instructions of the loop are not
+ *          counted, so the numbers are an upper bound for the XMEGA. A
+ *          write to DATA while a byte is still shifted out is a write
+ *          collision, like on the XMEGA.
+ *
+ *          Fails when a block has a write collision or does not arrive
+ *          byte for byte, so blocks over 255 bytes are checked too.
+ *
+ *          Built with SPI_STATS (spi_bench_stats) it also sends the frame
+ *          of a box fill, the commands byte by byte and the pixels as a
+ *          block, with and without spi_begin()/spi_end() around it. It
+ *          fails when the counters of spi.c do not show fewer chip select
+ *          edges in the transaction, or count other bytes than were sent.
+ *
+ *          Usage: spi_bench
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <avr/io.h>
+#include "spi.h"
+
+#define SPI_BENCH_ACCESS_CYCLES 3       // one LDS or STS with its branch or move
+#define SPI_BENCH_MAX_BLOCK     65535
+#define SPI_BENCH_IDLE          0x100   // DATA as the emulation leaves it
+
+PORT_t PORTD;
+
+static SPI_t spi = { .DATA = SPI_BENCH_IDLE };
+static uint64_t now;            // emulated CPU cycles
+static uint64_t busy_until;     // end of the byte that is shifted out
+static uint8_t shifting;
+static uint32_t sent;
+static uint32_t collisions;
+static uint8_t out[SPI_BENCH_MAX_BLOCK];
+static uint8_t block[SPI_BENCH_MAX_BLOCK];
+
+/* CPU cycles of one byte with the clock divider in CTRL */
+static uint32_t byte_cycles(void)
+{
+    static const uint8_t div[4] = { 4, 16, 64, 128 };
+    uint32_t d = div[spi.CTRL & SPI_PRESCALER_gm];
+
+    if (spi.CTRL & SPI_CLK2X_bm) {
+        d /= 2;
+    }
+    return 8 * d;
+}
+
+/* Handles the access before this one, then lets the caller access the registers */
+SPI_t *spi_host_access(void)
+{
+    if (spi.DATA != SPI_BENCH_IDLE) {
+        if (shifting && now < busy_until) {
+            spi.STATUS |= SPI_WRCOL_bm;
+            collisions++;
+        } else {
+            if (sent < SPI_BENCH_MAX_BLOCK) {
+                out[sent] = (uint8_t) spi.DATA;
+            }
+            sent++;
+            spi.STATUS &= (uint8_t) ~SPI_IF_bm;
+            busy_until = now + byte_cycles();
+            shifting = 1;
+        }
+        spi.DATA = SPI_BENCH_IDLE;
+    }
+    if (shifting && now >= busy_until) {
+        spi.STATUS |= SPI_IF_bm;
+        shifting = 0;
+    }
+
+    now += SPI_BENCH_ACCESS_CYCLES;
+    return &spi;
+}
+
+/* Sends one block, returns the emulated cycles or 0 when it did not arrive intact */
+static uint64_t run_block(uint16_t len)
+{
+    uint64_t start;
+    uint32_t i;
+
+    sent = 0;
+    collisions = 0;
+    start = now;
+    spi_write_block(block, len);
+    spi_host_access();          // the last access of spi_write_block
+
+    if (collisions != 0 || sent != len) {
+        printf("%5u bytes: %lu sent, %lu collisions\n", len,
+               (unsigned long) sent, (unsigned long) collisions);
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        if (out[i] != block[i]) {
+            printf("%5u bytes: byte %lu differs\n", len, (unsigned long) i);
+            return 0;
+        }
+    }
+
+    return now - start;
+}
+
+#ifdef SPI_STATS
+/*
+ * One frame like ucglib sends for a box: column and row address with four
+ * parameters each, memory write and the pixels. Returns the chip select
+ * edges counted by spi.c, or 0 when the bytes do not match.
+ */
+static uint32_t run_frame(uint8_t transaction)
+{
+    static const uint8_t column[] = { 0x2a, 0x00, 0x10, 0x00, 0x1f };
+    static const uint8_t row[] = { 0x2b, 0x00, 0x20, 0x00, 0x2f };
+    spi_stats_t stats;
+    uint32_t i, len;
+
+    spi_reset_stats();
+    sent = 0;
+    len = sizeof(column) + sizeof(row) + 1 + 512;
+    if (transaction) {
+        spi_begin();
+    }
+    for (i = 0; i < sizeof(column); i++) {
+        spi_write(column[i]);
+    }
+    for (i = 0; i < sizeof(row); i++) {
+        spi_write(row[i]);
+    }
+    spi_write(0x2c);
+    spi_write_block(block, 512);
+    if (transaction) {
+        spi_end();
+    }
+    spi_host_access();
+    spi_get_stats(&stats);
+
+    if (stats.bytes != len || sent != len || collisions != 0) {
+        printf("frame: %lu bytes counted, %lu sent, %lu collisions\n",
+               (unsigned long) stats.bytes, (unsigned long) sent, (unsigned long) collisions);
+        return 0;
+    }
+
+    return stats.cs_edges;
+}
+
+/* Fails when a transaction does not save chip select edges */
+static uint8_t run_frames(void)
+{
+    uint32_t single, transaction;
+
+    single = run_frame(0);
+    transaction = run_frame(1);
+    printf("cs edges per frame: %lu without, %lu with spi_begin/spi_end\n",
+           (unsigned long) single, (unsigned long) transaction);
+
+    return single == 0 || transaction == 0 || transaction >= single;
+}
+#endif
+
+int main(void)
+{
+    static const uint16_t sizes[] = { 1, 2, 16, 64, 255, 256, 1024, 4096, 65535 };
+    uint64_t cycles;
+    uint32_t i;
+    uint8_t failed = 0;
+
+    for (i = 0; i < SPI_BENCH_MAX_BLOCK; i++) {
+        block[i] = (uint8_t) (i * 7 + (i >> 8));
+    }
+
+    spi_init();
+    printf("bus limit: %.4f bytes/cycle\n", 1.0 / byte_cycles());
+    printf("%5s %10s %12s\n", "bytes", "cycles", "bytes/cycle");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        cycles = run_block(sizes[i]);
+        if (cycles == 0) {
+            failed = 1;
+            continue;
+        }
+        printf("%5u %10llu %12.4f\n", sizes[i], (unsigned long long) cycles,
+               (double) sizes[i] / (double) cycles);
+    }
+#ifdef SPI_STATS
+    failed |= run_frames();
+#endif
+
+    return failed;
+}
@@ -0,0 +1,258 @@
+/*!
+ * \file    spi_dma_host.c
+ * \brief   Host (Linux) mock of spi.h and spi_dma.h, see spi_dma_host.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "spi_dma_host.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <avr/io.h>
+#include "spi.h"
+#include "spi_dma.h"
+#include "ucglib_host.h"
+#include "ucglib_xmega.h"
+
+/* Same layout as in src/spi_dma.c */
+typedef struct {
+    uint16_t blocks;
+    uint8_t block_len;
+    uint8_t tail_len;
+    uint8_t buf[SPI_DMA_BUF_SIZE];
+} spi_dma_xfer_t;
+
+PORT_t PORTD;
+
+static spi_dma_xfer_t xfer[SPI_DMA_BUFS];
+static uint8_t head;
+static uint8_t queued;
+static uint8_t end_pending;
+static uint8_t transaction;
+static spi_dma_callback_t idle_cb;
+static spi_dma_host_stats_t stats;
+
+static void host_send(const uint8_t *data, uint16_t len)
+{
+    if (len > 0) {
+        ucg_com_host_cb(NULL, UCG_COM_MSG_SEND_STR, len, (uint8_t *) data);
+    }
+}
+
+static void host_cs(uint8_t level)
+{
+    ucg_com_host_cb(NULL, UCG_COM_MSG_CHANGE_CS_LINE, level, NULL);
+}
+
+/* The head transfer is done: its bytes reach the display */
+static void host_complete(void)
+{
+    spi_dma_xfer_t *x = &xfer[head];
+    spi_dma_callback_t cb;
+
+    while (x->blocks > 0) {
+        host_send(x->buf, x->block_len);
+        x->blocks--;
+    }
+    host_send(x->buf, x->tail_len);
+
+    head = (head + 1) % SPI_DMA_BUFS;
+    if (--queued > 0) {
+        return;
+    }
+    if (end_pending) {
+        end_pending = 0;
+        transaction = 0;
+        host_cs(1);
+    }
+    cb = idle_cb;
+    idle_cb = NULL;
+    if (cb != NULL) {
+        cb();
+    }
+}
+
+/* Something that needs an idle bus: finish the queue, but count it */
+static void host_need_idle(void)
+{
+    if (queued) {
+        stats.violations++;
+        while (queued) {
+            host_complete();
+        }
+    }
+}
+
+/* Take over the writes of ucglib_xmega.c to the CD line */
+static void host_port(void)
+{
+    uint8_t set = PORTD.OUTSET;
+    uint8_t clr = PORTD.OUTCLR;
+
+    PORTD.OUTSET = 0;
+    PORTD.OUTCLR = 0;
+    if (((set | clr) & UCGLIB_CD_bm) == 0) {
+        return;
+    }
+    host_need_idle();
+    ucg_com_host_cb(NULL, UCG_COM_MSG_CHANGE_CD_LINE, (set & UCGLIB_CD_bm) != 0, NULL);
+}
+
+static spi_dma_xfer_t *host_claim(void)
+{
+    host_port();
+    if (queued == SPI_DMA_BUFS) {
+        stats.blocked++;
+        host_complete();
+    }
+
+    return &xfer[(head + queued) % SPI_DMA_BUFS];
+}
+
+static void host_queue(void)
+{
+    stats.transfers++;
+    if (queued > 0) {
+        stats.overlapped++;
+    }
+    queued++;
+}
+
+void spi_dma_host_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+const spi_dma_host_stats_t *spi_dma_host_get_stats(void)
+{
+    return &stats;
+}
+
+/* spi.h */
+
+void spi_init(void)
+{
+    head = 0;
+    queued = 0;
+    end_pending = 0;
+    transaction = 0;
+    idle_cb = NULL;
+    memset(&PORTD, 0, sizeof(PORTD));
+    ucg_com_host_cb(NULL, UCG_COM_MSG_POWER_UP, 0, NULL);
+}
+
+void spi_write(uint8_t data)
+{
+    host_port();
+    host_need_idle();
+    ucg_com_host_cb(NULL, UCG_COM_MSG_SEND_BYTE, data, NULL);
+}
+
+void spi_write_block(const uint8_t *data, uint16_t len)
+{
+    host_port();
+    host_need_idle();
+    host_send(data, len);
+}
+
+void spi_begin(void)
+{
+    host_port();
+    host_need_idle();
+    if (!transaction) {
+        transaction = 1;
+        host_cs(0);
+    }
+}
+
+void spi_end(void)
+{
+    host_port();
+    host_need_idle();
+    if (transaction) {
+        transaction = 0;
+        host_cs(1);
+    }
+}
+
+/* spi_dma.h */
+
+void spi_dma_init(void)
+{
+}
+
+void spi_dma_on_idle(spi_dma_callback_t cb)
+{
+    if (queued) {
+        idle_cb = cb;
+    } else if (cb != NULL) {
+        cb();
+    }
+}
+
+void spi_dma_write(const uint8_t *data, uint16_t len)
+{
+    spi_dma_xfer_t *x;
+
+    if (data == NULL || len == 0) {
+        return;
+    }
+    if (len > SPI_DMA_BUF_SIZE) {
+        spi_dma_wait();
+        spi_write_block(data, len);
+        return;
+    }
+
+    x = host_claim();
+    memcpy(x->buf, data, len);
+    x->blocks = 0;
+    x->block_len = 0;
+    x->tail_len = len;
+    host_queue();
+}
+
+void spi_dma_repeat(const uint8_t *pattern, uint8_t size, uint16_t count)
+{
+    spi_dma_xfer_t *x;
+    uint8_t n, i;
+
+    if (pattern == NULL || size == 0 || size > SPI_DMA_BUF_SIZE || count == 0) {
+        return;
+    }
+
+    x = host_claim();
+    n = SPI_DMA_BUF_SIZE / size;
+    if (count < n) {
+        n = count;
+    }
+    for (i = 0; i < n * size; i++) {
+        x->buf[i] = pattern[i % size];
+    }
+    x->blocks = count / n;
+    x->block_len = n * size;
+    x->tail_len = (count % n) * size;
+    host_queue();
+}
+
+void spi_dma_end(void)
+{
+    host_port();
+    if (queued) {
+        end_pending = 1;
+    } else {
+        spi_end();
+    }
+}
+
+uint8_t spi_dma_busy(void)
+{
+    return queued != 0;
+}
+
+void spi_dma_wait(void)
+{
+    host_port();
+    while (queued) {
+        host_complete();
+    }
+}
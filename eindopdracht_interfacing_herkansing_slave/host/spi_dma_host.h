@@ -0,0 +1,32 @@
+/*!
+ * \file    spi_dma_host.h
+ * \brief   Host (Linux) mock of the display bus behind ucg_com_xmega_cb:
+ *          spi.h and spi_dma.h are implemented on top of the ST7735
+ *          emulator of ucglib_host.c, so the real com callback can be run
+ *          on the host.
+ *
+ *          The mock has the buffers of src/spi_dma.c. A queued
+ *          transfer reaches the display only when it is done: when a new
+ *          transfer needs its buffer, or on spi_dma_wait(). A change of the
+ *          CD or CS line, or a blocking write, while a transfer is still
+ *          queued would corrupt the stream on the XMEGA; the mock counts it
+ *          as a violation.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef SPI_DMA_HOST_H
+#define SPI_DMA_HOST_H
+
+#include <stdint.h>
+
+typedef struct spi_dma_host_stats {
+    uint32_t transfers;  /* DMA transfers queued */
+    uint32_t overlapped; /* transfers queued while another one was sent */
+    uint32_t blocked;    /* transfers that had to wait for a free buffer */
+    uint32_t violations; /* line changes or blocking writes during a transfer */
+} spi_dma_host_stats_t;
+
+void spi_dma_host_reset_stats(void);
+const spi_dma_host_stats_t *spi_dma_host_get_stats(void);
+
+#endif /* SPI_DMA_HOST_H */
@@ -0,0 +1,56 @@
+/*!
+ * \file    io.h
+ * \brief   Host stand-in for <avr/io.h>, only what ucglib_xmega.c and
+ *          spi.c use. The writes to OUTSET and OUTCLR of the port of the RST
+ *          and CD lines are picked up by the DMA mock in spi_dma_host.c.
+ *
+ *          Every access to SPID goes through spi_host_access() of the SPI
+ *          emulation in spi_bench.c. DATA is wider than the register of
+ *          the XMEGA, so the emulation can tell a written byte from the
+ *          value it left there.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+typedef struct {
+    volatile uint8_t DIRSET;
+    volatile uint8_t DIRCLR;
+    volatile uint8_t OUTSET;
+    volatile uint8_t OUTCLR;
+} PORT_t;
+
+extern PORT_t PORTD;
+
+typedef struct {
+    volatile uint8_t CTRL;
+    volatile uint8_t INTCTRL;
+    volatile uint8_t STATUS;
+    volatile uint16_t DATA;
+} SPI_t;
+
+SPI_t *spi_host_access(void);
+
+#define SPID    (*spi_host_access())
+
+#define SPI_CLK2X_bm            0x80
+#define SPI_ENABLE_bm           0x40
+#define SPI_DORD_bm             0x20
+#define SPI_MASTER_bm           0x10
+#define SPI_MODE_0_gc           0x00
+#define SPI_PRESCALER_gm        0x03
+#define SPI_PRESCALER_DIV4_gc   0x00
+#define SPI_IF_bm               0x80
+#define SPI_WRCOL_bm            0x40
+
+#define PIN2_bm 0x04
+#define PIN3_bm 0x08
+#define PIN4_bm 0x10
+#define PIN5_bm 0x20
+#define PIN6_bm 0x40
+#define PIN7_bm 0x80
+
+#endif /* HOST_AVR_IO_H */
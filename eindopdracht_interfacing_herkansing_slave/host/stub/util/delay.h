@@ -0,0 +1,13 @@
+/*!
+ * \file    delay.h
+ * \brief   Host stand-in for <util/delay.h>: the emulated display does not
+ *          need the delays.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#define _delay_us(us)   ((void) (us))
+
+#endif /* HOST_UTIL_DELAY_H */
@@ -0,0 +1,286 @@
+/*!
+ * \file    telemetry_bench.c
+ * \brief   Benchmarks of the telemetry packets on the host.
+ *
+ *          decode: the time of the decoding on the slave, the binary packet
+ *          of telemetry.c against the text path it replaced, where the
+ *          master sent "%f,%f" and the slave split it with strtok and read
+ *          it with atof. Both decoders get the same samples. The time is
+ *          measured with clock_gettime over many rounds and given in
+ *          nanoseconds per sample; these are host numbers, not XMEGA
+ *          cycles, but the ratio shows the difference in work. On the XMEGA the text path also
+ *          needs the float library of avr-libc.
+ *
+ *          Fails when the decoders do not give the same values (within the
+ *          rounding of Q4.11) or when the binary decode is not faster.
+ *
+ *          airtime: the samples per second the radio can deliver at 250 kbps
+ *          without retransmits, from telemetry_airtime_us(), for a fixed
+ *          packet of every batch size and for compact packets of a slow and
+ *          a fast signal. Fails when a larger batch does not deliver more,
+ *          or a compact packet fewer than a full fixed one.
+ *
+ *          Usage: telemetry_bench <case>
+ * \version 1.0
+ * \date    17-10-2026
+ */
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry.h"
+
+#define BENCH_SAMPLES   (TELEMETRY_MAX_BATCH * 64)
+#define BENCH_ROUNDS    2000
+#define TEXT_SIZE       32      // rx_packet and full_buffer of the old slave
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(void);
+} bench_case_t;
+
+typedef struct {
+    float x;
+    float y;
+} text_sample_t;
+
+static uint32_t failures;
+static uint32_t seed = 1;
+static volatile int32_t sink;   // keeps the decoded values alive
+
+static telemetry_sample_t samples[BENCH_SAMPLES];
+
+static int16_t random_value(int16_t range)
+{
+    seed = seed * 1103515245UL + 12345UL;
+    return (int16_t) ((int32_t) ((seed >> 8) % (2 * (uint32_t) range + 1)) - range);
+}
+
+static double now_ns(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+/* Samples of a tilted board with some noise, within 2 g like the master reads */
+static void make_samples(void)
+{
+    uint16_t i;
+
+    for (i = 0; i < BENCH_SAMPLES; i++) {
+        samples[i].seq = i;
+        samples[i].timestamp = 1000UL * i;
+        samples[i].x = (int16_t) (TELEMETRY_ONE_G / 2 + random_value(TELEMETRY_ONE_G));
+        samples[i].y = (int16_t) (-TELEMETRY_ONE_G / 4 + random_value(TELEMETRY_ONE_G));
+        samples[i].z = (int16_t) (TELEMETRY_ONE_G + random_value(TELEMETRY_ONE_G / 8));
+    }
+}
+
+/* The old slave: copy, split at the comma, convert both halves */
+static void text_decode(const char *rx_packet, text_sample_t *s)
+{
+    char full_buffer[TEXT_SIZE];
+    char x_buffer[16];
+    char y_buffer[16];
+
+    strncpy(full_buffer, rx_packet, sizeof(full_buffer));
+    strncpy(x_buffer, strtok(full_buffer, ","), sizeof(x_buffer));
+    strncpy(y_buffer, strtok(NULL, ","), sizeof(y_buffer));
+
+    s->x = (float) atof(x_buffer);
+    s->y = (float) atof(y_buffer);
+}
+
+static uint32_t test_decode(void)
+{
+    static char text[BENCH_SAMPLES][TEXT_SIZE];
+    static uint8_t packets[BENCH_SAMPLES / TELEMETRY_MAX_BATCH][TELEMETRY_MAX_SIZE];
+    static uint8_t lengths[BENCH_SAMPLES / TELEMETRY_MAX_BATCH];
+    telemetry_sample_t batch[TELEMETRY_MAX_BATCH];
+    text_sample_t t;
+    double start, text_ns, binary_ns;
+    uint16_t i, j, round;
+    uint8_t count;
+    int32_t sum;
+
+    make_samples();
+
+    /* The old master sent the acceleration in g with the default precision */
+    for (i = 0; i < BENCH_SAMPLES; i++) {
+        snprintf(text[i], TEXT_SIZE, "%f,%f", samples[i].x / (double) TELEMETRY_ONE_G,
+                 samples[i].y / (double) TELEMETRY_ONE_G);
+    }
+    for (i = 0; i < BENCH_SAMPLES / TELEMETRY_MAX_BATCH; i++) {
+        lengths[i] = telemetry_encode(&samples[i * TELEMETRY_MAX_BATCH], TELEMETRY_MAX_BATCH,
+                                      packets[i], TELEMETRY_MAX_SIZE);
+        if (lengths[i] == 0) {
+            printf("packet %u not encoded\n", i);
+            return ++failures;
+        }
+    }
+
+    /* Both paths give the same acceleration; %f keeps 6 decimals, Q4.11 has 1/2048 */
+    for (i = 0; i < BENCH_SAMPLES / TELEMETRY_MAX_BATCH; i++) {
+        if (telemetry_decode(batch, TELEMETRY_MAX_BATCH, &count, packets[i], lengths[i])
+                != TELEMETRY_OK || count != TELEMETRY_MAX_BATCH) {
+            printf("packet %u not decoded\n", i);
+            return ++failures;
+        }
+        for (j = 0; j < count; j++) {
+            text_decode(text[i * TELEMETRY_MAX_BATCH + j], &t);
+            if ((int32_t) (t.x * TELEMETRY_ONE_G + (t.x < 0 ? -0.5f : 0.5f)) != batch[j].x ||
+                (int32_t) (t.y * TELEMETRY_ONE_G + (t.y < 0 ? -0.5f : 0.5f)) != batch[j].y) {
+                printf("sample %u: text %s, binary %d,%d\n", i * TELEMETRY_MAX_BATCH + j,
+                       text[i * TELEMETRY_MAX_BATCH + j], batch[j].x, batch[j].y);
+                failures++;
+            }
+        }
+    }
+    if (failures) {
+        return failures;
+    }
+
+    sum = 0;
+    start = now_ns();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (i = 0; i < BENCH_SAMPLES; i++) {
+            text_decode(text[i], &t);
+            sum += (int32_t) (t.x * TELEMETRY_ONE_G) + (int32_t) (t.y * TELEMETRY_ONE_G);
+        }
+    }
+    text_ns = (now_ns() - start) / ((double) BENCH_ROUNDS * BENCH_SAMPLES);
+    sink = sum;
+
+    sum = 0;
+    start = now_ns();
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (i = 0; i < BENCH_SAMPLES / TELEMETRY_MAX_BATCH; i++) {
+            telemetry_decode(batch, TELEMETRY_MAX_BATCH, &count, packets[i], lengths[i]);
+            for (j = 0; j < count; j++) {
+                sum += batch[j].x + batch[j].y;
+            }
+        }
+    }
+    binary_ns = (now_ns() - start) / ((double) BENCH_ROUNDS * BENCH_SAMPLES);
+    sink = sum;
+
+    printf("%-8s %12s\n", "decoder", "ns/sample");
+    printf("%-8s %12.1f\n", "text", text_ns);
+    printf("%-8s %12.1f\n", "binary", binary_ns);
+    printf("binary is %.1f times as fast\n", text_ns / binary_ns);
+
+    if (binary_ns >= text_ns) {
+        printf("the binary decode is not faster\n");
+        failures++;
+    }
+
+    return failures;
+}
+
+/* Samples per second over the radio when every packet holds n samples on average */
+static double rate(double n, uint8_t len)
+{
+    return 1e6 * n / telemetry_airtime_us(len);
+}
+
+/*
+ * Packs the samples in compact packets like the master does with
+ * TELEMETRY_DELTA and returns the mean samples per packet and the mean
+ * packet length.
+ */
+static double pack_delta(double *len)
+{
+    uint8_t buf[TELEMETRY_MAX_SIZE];
+    uint16_t i, packets = 0;
+    uint32_t bytes = 0;
+    uint8_t used, n;
+
+    for (i = 0; i + TELEMETRY_DELTA_MAX_BATCH <= BENCH_SAMPLES; i += used) {
+        n = telemetry_encode_delta(&samples[i], TELEMETRY_DELTA_MAX_BATCH, buf, sizeof(buf), &used);
+        if (n == 0) {
+            return 0;
+        }
+        bytes += n;
+        packets++;
+    }
+    *len = (double) bytes / packets;
+
+    return (double) i / packets;
+}
+
+static uint32_t test_airtime(void)
+{
+    static const char *const signals[] = { "slow", "fast" };
+    double last = 0, fixed, per_packet, len;
+    uint16_t i;
+    uint8_t n, k;
+
+    printf("%-8s %5s %6s %8s %10s\n", "packet", "N", "bytes", "us", "samples/s");
+    for (n = 1; n <= TELEMETRY_MAX_BATCH; n++) {
+        fixed = rate(n, TELEMETRY_SIZE(n));
+        printf("%-8s %5u %6u %8u %10.0f\n", "fixed", n, TELEMETRY_SIZE(n),
+               telemetry_airtime_us(TELEMETRY_SIZE(n)), fixed);
+        if (fixed <= last) {
+            printf("N=%u delivers no more than N=%u\n", n, n - 1);
+            failures++;
+        }
+        last = fixed;
+    }
+
+    /* A board that is tilted slowly, and one that is shaken over the full range */
+    for (k = 0; k < 2; k++) {
+        for (i = 0; i < BENCH_SAMPLES; i++) {
+            samples[i].seq = i;
+            samples[i].timestamp = 1000UL * i;
+            samples[i].x = (int16_t) (k == 0 ? i + random_value(8) : random_value(2 * TELEMETRY_ONE_G));
+            samples[i].y = (int16_t) (k == 0 ? -i + random_value(8) : random_value(2 * TELEMETRY_ONE_G));
+            samples[i].z = (int16_t) (TELEMETRY_ONE_G + (k == 0 ? random_value(8) : random_value(2 * TELEMETRY_ONE_G)));
+        }
+        per_packet = pack_delta(&len);
+        if (per_packet == 0) {
+            printf("%s: not encoded\n", signals[k]);
+            failures++;
+            continue;
+        }
+        printf("%-8s %5.2f %6.1f %8u %10.0f\n", signals[k], per_packet, len,
+               telemetry_airtime_us((uint8_t) (len + 0.5)), rate(per_packet, (uint8_t) (len + 0.5)));
+        if (per_packet < TELEMETRY_MAX_BATCH) {
+            printf("%s: fewer samples per packet than a fixed packet\n", signals[k]);
+            failures++;
+        }
+    }
+
+    return failures;
+}
+
+static const bench_case_t cases[] = {
+    { "decode", test_decode },
+    { "airtime", test_airtime },
+};
+
+int main(int argc, char *argv[])
+{
+    uint32_t failed;
+    uint8_t i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: telemetry_bench <case>\n");
+        return 2;
+    }
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(argv[1], cases[i].name) == 0) {
+            failed = cases[i].run();
+            printf("%s: %s\n", cases[i].name, failed == 0 ? "ok" : "FAILED");
+            return failed == 0 ? 0 : 1;
+        }
+    }
+
+    fprintf(stderr, "unknown case %s\n", argv[1]);
+    return 2;
+}
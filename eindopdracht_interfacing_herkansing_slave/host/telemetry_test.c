@@ -0,0 +1,384 @@
+/*!
+ * \file    telemetry_test.c
+ * \brief   Tests of the telemetry packet on the host: the samples are
+ *          encoded and decoded again, with the boundary values of the
+ *          fields, and broken packets have to be rejected. src/telemetry.c
+ *          of the master is the same file, so this covers both ends.
+ *
+ *          Usage: telemetry_test <case>
+ * \version 1.2
+ * \date    16-10-2026
+ */
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "telemetry.h"
+
+#define CHECK(cond) check((cond), #cond, __LINE__)
+
+typedef struct {
+    const char *name;
+    uint32_t (*run)(void);
+} telemetry_case_t;
+
+static uint32_t failures;
+
+static void check(int ok, const char *what, int line)
+{
+    if (!ok) {
+        printf("line %d: %s\n", line, what);
+        failures++;
+    }
+}
+
+/* count samples from seq and timestamp on, period us apart, with x, y and z from values */
+static void make_samples(telemetry_sample_t *s, uint8_t count, uint16_t seq,
+                         uint32_t timestamp, uint16_t period,
+                         const int16_t *values, uint8_t nvalues)
+{
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        s[i].seq = seq + i;
+        s[i].timestamp = timestamp + (uint32_t) i * period;
+        s[i].x = values[(3 * i) % nvalues];
+        s[i].y = values[(3 * i + 1) % nvalues];
+        s[i].z = values[(3 * i + 2) % nvalues];
+    }
+}
+
+static uint8_t same_samples(const telemetry_sample_t *a, const telemetry_sample_t *b,
+                            uint8_t count)
+{
+    uint8_t i;
+
+    for (i = 0; i < count; i++) {
+        if (a[i].seq != b[i].seq || a[i].timestamp != b[i].timestamp ||
+            a[i].x != b[i].x || a[i].y != b[i].y || a[i].z != b[i].z) {
+            printf("sample %u: seq %u/%u x %d/%d y %d/%d z %d/%d\n", i,
+                   a[i].seq, b[i].seq, a[i].x, b[i].x, a[i].y, b[i].y, a[i].z, b[i].z);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* The extremes of Q4.11 and a sequence number that wraps inside the packet */
+static uint32_t test_fixed(void)
+{
+    static const int16_t values[] = { INT16_MIN, INT16_MAX, 0, -1, 1, TELEMETRY_ONE_G };
+    telemetry_sample_t in[TELEMETRY_MAX_BATCH];
+    telemetry_sample_t out[TELEMETRY_MAX_SAMPLES];
+    uint8_t buf[TELEMETRY_MAX_SIZE];
+    uint8_t count, len, n;
+
+    for (n = 1; n <= TELEMETRY_MAX_BATCH; n++) {
+        make_samples(in, n, 0xfffe, 0xfedcba98UL, 8000, values, sizeof(values) / sizeof(values[0]));
+        len = telemetry_encode(in, n, buf, sizeof(buf));
+        CHECK(len == TELEMETRY_SIZE(n));
+        CHECK(buf[0] == TELEMETRY_VERSION && buf[1] == n);
+        count = 0;
+        CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+        CHECK(count == n);
+        CHECK(same_samples(in, out, n));
+    }
+    CHECK(out[1].seq == 0xffff && out[2].seq == 0);
+
+    return failures;
+}
+
+/* Every sample gets its own time from the period in the header */
+static uint32_t test_timestamps(void)
+{
+    static const int16_t values[] = { 10, 20, 30 };
+    telemetry_sample_t in[TELEMETRY_MAX_SAMPLES];
+    telemetry_sample_t out[TELEMETRY_MAX_SAMPLES];
+    uint8_t buf[TELEMETRY_MAX_SIZE];
+    uint8_t count, len, used;
+
+    /* The 32 bit time wraps inside the packet */
+    make_samples(in, TELEMETRY_MAX_BATCH, 0, 0xffffe000UL, 8000, values, 3);
+    len = telemetry_encode(in, TELEMETRY_MAX_BATCH, buf, sizeof(buf));
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+    CHECK(same_samples(in, out, TELEMETRY_MAX_BATCH));
+    CHECK(out[1].timestamp == 0xffffff40UL && out[2].timestamp == 0x1e80);
+
+    make_samples(in, TELEMETRY_MAX_SAMPLES, 0, 123456, 2000, values, 3);
+    len = telemetry_encode_delta(in, TELEMETRY_MAX_SAMPLES, buf, sizeof(buf), &used);
+    CHECK(len > 0 && used == TELEMETRY_MAX_SAMPLES);
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+    CHECK(count == used && same_samples(in, out, used));
+
+    /* A single sample has no period */
+    len = telemetry_encode(in, 1, buf, sizeof(buf));
+    CHECK(buf[8] == 0 && buf[9] == 0);
+
+    /* Jitter: the mean period, the last sample is off by less than a microsecond per sample */
+    in[1].timestamp += 7;
+    in[2].timestamp += 5;
+    len = telemetry_encode(in, 3, buf, sizeof(buf));
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+    CHECK(out[0].timestamp == in[0].timestamp && out[1].timestamp == in[0].timestamp + 2002);
+    CHECK(in[2].timestamp - out[2].timestamp < 3);
+
+    /* More than 65535 us apart saturates */
+    in[1].timestamp = in[0].timestamp + 100000UL;
+    len = telemetry_encode(in, 2, buf, sizeof(buf));
+    CHECK(buf[8] == 0xff && buf[9] == 0xff);
+
+    return failures;
+}
+
+/* Packets that do not fit or are not ours leave the output alone */
+static uint32_t test_errors(void)
+{
+    static const int16_t values[] = { 100, -200, 300 };
+    telemetry_sample_t in[TELEMETRY_MAX_BATCH + 1];
+    telemetry_sample_t out[TELEMETRY_MAX_SAMPLES];
+    uint8_t buf[TELEMETRY_MAX_SIZE + 8];
+    uint8_t count, len;
+
+    make_samples(in, TELEMETRY_MAX_BATCH + 1, 7, 1000, 4000, values, 3);
+
+    /* Encoder: no samples, too many samples, a buffer that is one byte short */
+    CHECK(telemetry_encode(in, 0, buf, sizeof(buf)) == 0);
+    CHECK(telemetry_encode(in, TELEMETRY_MAX_BATCH + 1, buf, sizeof(buf)) == 0);
+    CHECK(telemetry_encode(in, 2, buf, TELEMETRY_SIZE(2) - 1) == 0);
+    CHECK(telemetry_encode(NULL, 1, buf, sizeof(buf)) == 0);
+
+    len = telemetry_encode(in, 2, buf, sizeof(buf));
+    CHECK(len == TELEMETRY_SIZE(2));
+
+    /* Decoder: every length but the right one */
+    count = 0xaa;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, 0) == TELEMETRY_ERR_LENGTH);
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf,
+                           TELEMETRY_HEADER_SIZE - 1) == TELEMETRY_ERR_LENGTH);
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len - 1) == TELEMETRY_ERR_LENGTH);
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len + 1) == TELEMETRY_ERR_LENGTH);
+    CHECK(count == 0xaa);
+
+    /* No room for the samples */
+    CHECK(telemetry_decode(out, 1, &count, buf, len) == TELEMETRY_ERR_LENGTH);
+
+    /* A count that does not match the length, or is out of range */
+    buf[1] = 1;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_ERR_LENGTH);
+    buf[1] = 0;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf,
+                           TELEMETRY_HEADER_SIZE) == TELEMETRY_ERR_LENGTH);
+    buf[1] = TELEMETRY_MAX_BATCH + 1;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf,
+                           TELEMETRY_SIZE(TELEMETRY_MAX_BATCH + 1)) == TELEMETRY_ERR_LENGTH);
+    buf[1] = 2;
+
+    /* Another version */
+    buf[0] = 2;     /* the fixed packet before it had a period */
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_ERR_VERSION);
+    buf[0] = 0xff;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_ERR_VERSION);
+    CHECK(count == 0xaa);
+
+    buf[0] = TELEMETRY_VERSION;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+    CHECK(count == 2 && same_samples(in, out, 2));
+
+    return failures;
+}
+
+/*
+ * Encodes count samples with telemetry_encode_delta() and decodes them
+ * again. Returns the number of samples that went in, 0 when they did not
+ * come back; the length and the version of the packet in len and version.
+ */
+static uint8_t delta_roundtrip(const telemetry_sample_t *in, uint8_t count, uint8_t *len,
+                               uint8_t *version)
+{
+    telemetry_sample_t out[TELEMETRY_MAX_SAMPLES];
+    uint8_t buf[TELEMETRY_MAX_SIZE];
+    uint8_t used = 0, n = 0;
+
+    *len = telemetry_encode_delta(in, count, buf, sizeof(buf), &used);
+    *version = buf[0];
+    if (*len == 0 || buf[1] != used
+            || telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &n, buf, *len) != TELEMETRY_OK
+            || n != used || !same_samples(in, out, used)) {
+        return 0;
+    }
+
+    return used;
+}
+
+/*
+ * The zig-zag edges, and the fewest and the most samples in one packet:
+ * never fewer than in a fixed packet
+ */
+static uint32_t test_delta(void)
+{
+    static const int16_t edges[] = { INT16_MAX, -INT16_MAX, INT16_MIN, 64, -64, 63, -63, 1, -1, 0 };
+    static const int16_t slow[] = { 100, -100, 2000, 163, -163, 2063 };    /* changes of 63 */
+    static const int16_t fast[] = { 0, 0, INT16_MIN, INT16_MAX, -INT16_MAX, -1 };
+    telemetry_sample_t in[TELEMETRY_DELTA_MAX_BATCH + 2];
+    uint8_t i, len, version;
+
+    /* Every edge as the change of x, y and z; the last two wrap modulo 2^16 */
+    for (i = 0; i < sizeof(edges) / sizeof(edges[0]); i++) {
+        make_samples(in, 2, 0, 0, 1000, fast, 3);
+        in[1].x = (int16_t) (in[0].x + edges[i]);
+        in[1].y = (int16_t) ((uint16_t) in[0].y - (uint16_t) edges[i]);
+        in[1].z = (int16_t) ((uint16_t) in[0].z + (uint16_t) edges[i]);
+        CHECK(delta_roundtrip(in, 2, &len, &version) == 2 && version == TELEMETRY_VERSION_DELTA);
+        if (edges[i] == INT16_MAX || edges[i] == -INT16_MAX || edges[i] == INT16_MIN) {
+            /* zig-zag 65534, 65533 and 65535 take three bytes */
+            CHECK(len == TELEMETRY_DELTA_HEADER_SIZE + 3 * TELEMETRY_DELTA_MAX_BYTES);
+        }
+    }
+
+    /* Changes of three bytes only: TELEMETRY_DELTA_MIN_BATCH fit, one more does not */
+    make_samples(in, TELEMETRY_DELTA_MAX_BATCH, 0, 5000, 2000, fast + 2, 4);
+    for (i = 1; i < TELEMETRY_DELTA_MAX_BATCH; i++) {
+        in[i].x = (i & 1) ? INT16_MAX : 0;
+        in[i].y = (i & 1) ? INT16_MIN : 0;
+        in[i].z = (i & 1) ? -INT16_MAX : 0;
+    }
+    in[0].x = in[0].y = in[0].z = 0;
+    CHECK(delta_roundtrip(in, TELEMETRY_DELTA_MIN_BATCH, &len, &version) == TELEMETRY_DELTA_MIN_BATCH);
+    CHECK(version == TELEMETRY_VERSION_DELTA);
+    CHECK(len == TELEMETRY_DELTA_HEADER_SIZE
+          + (TELEMETRY_DELTA_MIN_BATCH - 1) * 3 * TELEMETRY_DELTA_MAX_BYTES);
+    CHECK(len + 3 * TELEMETRY_DELTA_MAX_BYTES > TELEMETRY_MAX_SIZE);
+    CHECK(delta_roundtrip(in, 1, &len, &version) == 1 && len == TELEMETRY_DELTA_HEADER_SIZE);
+
+    /* With more samples the fixed packet holds more, so that one is sent */
+    CHECK(TELEMETRY_DELTA_MIN_BATCH < TELEMETRY_MAX_BATCH);
+    CHECK(delta_roundtrip(in, TELEMETRY_DELTA_MAX_BATCH, &len, &version) == TELEMETRY_MAX_BATCH);
+    CHECK(version == TELEMETRY_VERSION && len == TELEMETRY_SIZE(TELEMETRY_MAX_BATCH));
+    CHECK(delta_roundtrip(in, TELEMETRY_MAX_BATCH, &len, &version) == TELEMETRY_MAX_BATCH);
+    CHECK(version == TELEMETRY_VERSION);
+
+    /* Changes of one byte: TELEMETRY_DELTA_MAX_BATCH, more are left for the next packet */
+    make_samples(in, TELEMETRY_DELTA_MAX_BATCH + 2, 0xfffc, 0xffffff00UL, 2000, slow, 6);
+    CHECK(delta_roundtrip(in, TELEMETRY_DELTA_MAX_BATCH, &len, &version) == TELEMETRY_DELTA_MAX_BATCH);
+    CHECK(version == TELEMETRY_VERSION_DELTA);
+    CHECK(len == TELEMETRY_DELTA_HEADER_SIZE + (TELEMETRY_DELTA_MAX_BATCH - 1) * 3);
+    CHECK(delta_roundtrip(in, TELEMETRY_DELTA_MAX_BATCH + 2, &len, &version) == TELEMETRY_DELTA_MAX_BATCH);
+
+    return failures;
+}
+
+/* Broken compact packets: truncated or too long varints and too many samples */
+static uint32_t test_delta_errors(void)
+{
+    static const int16_t slow[] = { 100, -100, 2000, 101, -101, 2001 };
+    telemetry_sample_t in[TELEMETRY_DELTA_MAX_BATCH];
+    telemetry_sample_t out[TELEMETRY_MAX_SAMPLES + 1];
+    uint8_t buf[TELEMETRY_MAX_SIZE + 8];
+    uint8_t count, len, cut, used;
+
+    /* Two samples with three byte changes */
+    make_samples(in, 2, 3, 1000, 4000, slow, 3);
+    in[1].x = INT16_MAX;
+    in[1].y = INT16_MIN;
+    in[1].z = -INT16_MAX;
+    len = telemetry_encode_delta(in, 2, buf, TELEMETRY_MAX_SIZE, &used);
+    CHECK(used == 2 && len == TELEMETRY_DELTA_HEADER_SIZE + 3 * TELEMETRY_DELTA_MAX_BYTES);
+
+    /* Every cut inside the deltas ends in a truncated varint or a missing one */
+    count = 0xaa;
+    for (cut = TELEMETRY_DELTA_HEADER_SIZE; cut < len; cut++) {
+        CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, cut) == TELEMETRY_ERR_LENGTH);
+    }
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf,
+                           TELEMETRY_DELTA_HEADER_SIZE - 1) == TELEMETRY_ERR_LENGTH);
+
+    /* A byte after the last delta */
+    buf[len] = 0;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len + 1) == TELEMETRY_ERR_LENGTH);
+
+    /* The last varint says another byte follows, but the packet ends */
+    buf[len - 1] |= 0x80;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_ERR_LENGTH);
+
+    /* ... and with that byte it is a varint of four bytes */
+    buf[len] = 0x01;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len + 1) == TELEMETRY_ERR_LENGTH);
+    buf[len - 1] &= 0x7f;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES, &count, buf, len) == TELEMETRY_OK);
+    CHECK(count == 2 && same_samples(in, out, 2));
+
+    /* A full batch of one byte changes, then one sample more than TELEMETRY_DELTA_MAX_BATCH */
+    make_samples(in, TELEMETRY_DELTA_MAX_BATCH, 3, 1000, 4000, slow, 6);
+    len = telemetry_encode_delta(in, TELEMETRY_DELTA_MAX_BATCH, buf, TELEMETRY_MAX_SIZE, &used);
+    CHECK(used == TELEMETRY_DELTA_MAX_BATCH);
+    buf[len] = buf[len + 1] = buf[len + 2] = 0;
+    buf[1] = TELEMETRY_DELTA_MAX_BATCH + 1;
+    count = 0xaa;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES + 1, &count, buf, len + 3) == TELEMETRY_ERR_LENGTH);
+    buf[1] = 0;
+    CHECK(telemetry_decode(out, TELEMETRY_MAX_SAMPLES + 1, &count, buf,
+                           TELEMETRY_DELTA_HEADER_SIZE) == TELEMETRY_ERR_LENGTH);
+    CHECK(count == 0xaa);
+
+    /* No room for the samples */
+    buf[1] = TELEMETRY_DELTA_MAX_BATCH;
+    CHECK(telemetry_decode(out, TELEMETRY_DELTA_MAX_BATCH - 1, &count, buf, len) == TELEMETRY_ERR_LENGTH);
+    CHECK(telemetry_decode(out, TELEMETRY_DELTA_MAX_BATCH, &count, buf, len) == TELEMETRY_OK);
+
+    /* Encoder: no samples, a buffer without room for the first one */
+    CHECK(telemetry_encode_delta(in, 0, buf, TELEMETRY_MAX_SIZE, &used) == 0);
+    CHECK(telemetry_encode_delta(in, 2, buf, TELEMETRY_DELTA_HEADER_SIZE - 1, &used) == 0);
+    CHECK(telemetry_encode_delta(in, 2, buf, TELEMETRY_MAX_SIZE, NULL) == 0);
+
+    return failures;
+}
+
+static uint32_t test_ack(void)
+{
+    uint8_t buf[TELEMETRY_ACK_SIZE];
+    uint16_t received = 0;
+
+    CHECK(telemetry_encode_ack(0xffff, buf, sizeof(buf) - 1) == 0);
+    CHECK(telemetry_encode_ack(0xffff, buf, sizeof(buf)) == TELEMETRY_ACK_SIZE);
+    CHECK(telemetry_decode_ack(&received, buf, TELEMETRY_ACK_SIZE) == TELEMETRY_OK);
+    CHECK(received == 0xffff);
+
+    received = 5;
+    CHECK(telemetry_decode_ack(&received, buf, TELEMETRY_ACK_SIZE - 1) == TELEMETRY_ERR_LENGTH);
+    buf[0] = TELEMETRY_VERSION + 1;
+    CHECK(telemetry_decode_ack(&received, buf, TELEMETRY_ACK_SIZE) == TELEMETRY_ERR_VERSION);
+    CHECK(received == 5);
+
+    return failures;
+}
+
+static const telemetry_case_t cases[] = {
+    { "fixed", test_fixed },
+    { "timestamps", test_timestamps },
+    { "errors", test_errors },
+    { "delta", test_delta },
+    { "delta_errors", test_delta_errors },
+    { "ack", test_ack },
+};
+
+int main(int argc, char *argv[])
+{
+    uint32_t failed;
+    uint8_t i;
+
+    if (argc < 2) {
+        fprintf(stderr, "usage: telemetry_test <case>\n");
+        return 2;
+    }
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        if (strcmp(argv[1], cases[i].name) == 0) {
+            failed = cases[i].run();
+            printf("%s: %s\n", cases[i].name, failed == 0 ? "ok" : "FAILED");
+            return failed == 0 ? 0 : 1;
+        }
+    }
+
+    fprintf(stderr, "unknown case %s\n", argv[1]);
+    return 2;
+}
@@ -0,0 +1,241 @@
+#include "ucglib_host.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* ST7735 commands that change the emulated GRAM state */
+#define ST7735_CASET  0x2a
+#define ST7735_RASET  0x2b
+#define ST7735_RAMWR  0x2c
+#define ST7735_MADCTL 0x36
+#define ST7735_COLMOD 0x3a
+
+#define ST7735_MADCTL_MY 0x80
+#define ST7735_MADCTL_MX 0x40
+#define ST7735_MADCTL_MV 0x20
+
+typedef struct st7735_state {
+    uint8_t cd;           /* level of the CD line, 0 = command */
+    uint8_t cmd;          /* last command byte */
+    uint8_t argc;         /* number of argument bytes received for cmd */
+    uint8_t args[4];
+    uint8_t madctl;
+    uint8_t colmod;
+    uint16_t xs, xe, ys, ye;
+    uint16_t c, r;        /* GRAM address counter */
+    uint8_t pix[3];       /* partially received pixel */
+    uint8_t pix_cnt;
+} st7735_state_t;
+
+static ucg_host_fb_t framebuffer;
+static ucg_host_stats_t stats;
+static st7735_state_t st = { .colmod = 0x06 };
+
+static void st7735_put_pixel(void)
+{
+    uint16_t px, py, tmp;
+    uint8_t *p;
+
+    px = st.c;
+    py = st.r;
+    if (st.madctl & ST7735_MADCTL_MV) {
+        tmp = px;
+        px = py;
+        py = tmp;
+    }
+    if (st.madctl & ST7735_MADCTL_MX) {
+        px = (UCGLIB_HOST_WIDTH - 1) - px;
+    }
+    if (st.madctl & ST7735_MADCTL_MY) {
+        py = (UCGLIB_HOST_HEIGHT - 1) - py;
+    }
+
+    if (px < UCGLIB_HOST_WIDTH && py < UCGLIB_HOST_HEIGHT) {
+        p = framebuffer[py][px];
+        if ((st.colmod & 0x07) == 0x05) {
+            /* 16 bit: RRRRRGGG GGGBBBBB */
+            p[0] = st.pix[0] & 0xf8;
+            p[1] = (uint8_t)((st.pix[0] << 5) | ((st.pix[1] >> 3) & 0x1c));
+            p[2] = (uint8_t)(st.pix[1] << 3);
+        } else {
+            /* 18 bit: the panel only uses the upper 6 bits of each byte */
+            p[0] = st.pix[0] & 0xfc;
+            p[1] = st.pix[1] & 0xfc;
+            p[2] = st.pix[2] & 0xfc;
+        }
+    }
+    stats.pixels++;
+
+    /* advance the address counter within the window */
+    if (st.c < st.xe) {
+        st.c++;
+    } else {
+        st.c = st.xs;
+        st.r = (st.r < st.ye) ? st.r + 1 : st.ys;
+    }
+}
+
+static void st7735_write(uint8_t byte)
+{
+    stats.bytes++;
+
+    if (st.cd == 0) {
+        stats.cmd_bytes++;
+        st.cmd = byte;
+        st.argc = 0;
+        st.pix_cnt = 0;
+        if (byte == ST7735_RAMWR) {
+            stats.windows++;
+            st.c = st.xs;
+            st.r = st.ys;
+        }
+        return;
+    }
+
+    stats.data_bytes++;
+    switch (st.cmd) {
+    case ST7735_CASET:
+    case ST7735_RASET:
+        if (st.argc < 4) {
+            st.args[st.argc++] = byte;
+        }
+        if (st.argc == 4) {
+            if (st.cmd == ST7735_CASET) {
+                st.xs = (st.args[0] << 8) | st.args[1];
+                st.xe = (st.args[2] << 8) | st.args[3];
+            } else {
+                st.ys = (st.args[0] << 8) | st.args[1];
+                st.ye = (st.args[2] << 8) | st.args[3];
+            }
+        }
+        break;
+    case ST7735_MADCTL:
+        st.madctl = byte;
+        break;
+    case ST7735_COLMOD:
+        st.colmod = byte;
+        break;
+    case ST7735_RAMWR:
+        st.pix[st.pix_cnt++] = byte;
+        if (st.pix_cnt == (((st.colmod & 0x07) == 0x05) ? 2 : 3)) {
+            st.pix_cnt = 0;
+            st7735_put_pixel();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+int16_t ucg_com_host_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
+{
+    (void)ucg;
+
+    switch(msg) {
+    case UCG_COM_MSG_POWER_UP:
+        memset(&st, 0, sizeof(st));
+        st.colmod = 0x06;
+        break;
+    case UCG_COM_MSG_POWER_DOWN:
+    case UCG_COM_MSG_DELAY:
+    case UCG_COM_MSG_CHANGE_RESET_LINE:
+        break;
+    case UCG_COM_MSG_CHANGE_CD_LINE:
+        st.cd = arg ? 1 : 0;
+        break;
+    case UCG_COM_MSG_CHANGE_CS_LINE:
+        stats.cs_edges++;
+        break;
+    case UCG_COM_MSG_SEND_BYTE:
+        st7735_write(arg);
+        break;
+    case UCG_COM_MSG_REPEAT_1_BYTE:
+        while (arg--) {
+            st7735_write(data[0]);
+        }
+        break;
+    case UCG_COM_MSG_REPEAT_2_BYTES:
+        while (arg--) {
+            st7735_write(data[0]);
+            st7735_write(data[1]);
+        }
+        break;
+    case UCG_COM_MSG_REPEAT_3_BYTES:
+        while (arg--) {
+            st7735_write(data[0]);
+            st7735_write(data[1]);
+            st7735_write(data[2]);
+        }
+        break;
+    case UCG_COM_MSG_SEND_STR:
+        while (arg--) {
+            st7735_write(*data++);
+        }
+        break;
+    case UCG_COM_MSG_SEND_CD_DATA_SEQUENCE:
+        while (arg > 0) {
+            if (*data != 0) {
+                st.cd = (*data == 1) ? 0 : 1;
+            }
+            data++;
+            st7735_write(*data);
+            data++;
+            arg--;
+        }
+        break;
+    default:
+        return 1;
+    }
+
+    return 1;
+}
+
+void ucg_host_reset_stats(void)
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+const ucg_host_stats_t *ucg_host_get_stats(void)
+{
+    return &stats;
+}
+
+const ucg_host_fb_t *ucg_host_get_framebuffer(void)
+{
+    return (const ucg_host_fb_t *) &framebuffer;
+}
+
+void ucg_host_copy_framebuffer(ucg_host_fb_t *dst)
+{
+    memcpy(dst, &framebuffer, sizeof(framebuffer));
+}
+
+/* Returns the number of pixels that differ from the reference framebuffer */
+uint32_t ucg_host_diff_framebuffer(const ucg_host_fb_t *ref)
+{
+    uint32_t diff = 0;
+
+    for (uint16_t y = 0; y < UCGLIB_HOST_HEIGHT; y++) {
+        for (uint16_t x = 0; x < UCGLIB_HOST_WIDTH; x++) {
+            if (memcmp(framebuffer[y][x], (*ref)[y][x], 3) != 0) {
+                diff++;
+            }
+        }
+    }
+
+    return diff;
+}
+
+int ucg_host_write_ppm(const char *filename)
+{
+    FILE *f = fopen(filename, "wb");
+
+    if (f == NULL) {
+        return -1;
+    }
+    fprintf(f, "P6\n%d %d\n255\n", UCGLIB_HOST_WIDTH, UCGLIB_HOST_HEIGHT);
+    fwrite(framebuffer, 1, sizeof(framebuffer), f);
+    fclose(f);
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*!
+ * \file    ucglib_host.h
+ * \brief   Host (Linux) stand-in for ucg_com_xmega_cb. The com callback
+ *          emulates the ST7735 controller on the byte level and renders
+ *          into an in-memory framebuffer, so the slave renderer can be
+ *          measured without the XMEGA and a scope.
+ *
+ *          The real ucg_dev_st7735_* device callbacks are kept in the loop:
+ *          every byte they would push over SPI is counted here, together
+ *          with the number of pixels written and the number of address
+ *          windows (one per ucglib draw primitive).
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef UCGLIB_HOST_H
+#define UCGLIB_HOST_H
+
+#include <stdint.h>
+#include "ucglib/csrc/ucg.h"
+
+/* Physical (unrotated) size of the ST7735 GRAM */
+#define UCGLIB_HOST_WIDTH  128
+#define UCGLIB_HOST_HEIGHT 160
+
+typedef uint8_t ucg_host_fb_t[UCGLIB_HOST_HEIGHT][UCGLIB_HOST_WIDTH][3];
+
+typedef struct ucg_host_stats {
+    uint32_t bytes;      /* all bytes clocked out on the display bus */
+    uint32_t cmd_bytes;  /* bytes sent with CD low (commands) */
+    uint32_t data_bytes; /* bytes sent with CD high (arguments and pixels) */
+    uint32_t pixels;     /* pixels written into GRAM */
+    uint32_t cs_edges;   /* transitions of the chip select line */
+    uint32_t windows;    /* RAMWR commands, one per draw primitive */
+} ucg_host_stats_t;
+
+int16_t ucg_com_host_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data);
+
+void ucg_host_reset_stats(void);
+const ucg_host_stats_t *ucg_host_get_stats(void);
+
+const ucg_host_fb_t *ucg_host_get_framebuffer(void);
+void ucg_host_copy_framebuffer(ucg_host_fb_t *dst);
+uint32_t ucg_host_diff_framebuffer(const ucg_host_fb_t *ref);
+int ucg_host_write_ppm(const char *filename);
+
+#endif /* UCGLIB_HOST_H */
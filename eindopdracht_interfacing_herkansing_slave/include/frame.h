@@ -0,0 +1,50 @@
+/*!
+ * \file    frame.h
+ * \brief   Frame pacing of the slave render loop.
+ *
+ *          FRAME_TIMER overflows FRAME_FPS times per second and counts
+ *          frame ticks in its interrupt. The main loop calls frame_due()
+ *          as often as it likes; it returns the number of ticks since the
+ *          previous due frame, or 0 when no frame is due yet. Motion is
+ *          integrated over that number of ticks, so the balls move at the
+ *          same speed when a frame is late. The number of ticks is capped
+ *          at FRAME_MAX_TICKS so a long stall does not make a ball jump.
+ *
+ *          A due frame in which no disc moved a whole pixel is counted as
+ *          skipped, the other ones as rendered (frame_done()).
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+
+#define FRAME_TIMER         TCE0
+#define FRAME_TIMER_VEC     TCE0_OVF_vect
+
+#define FRAME_FPS           50
+#define FRAME_MAX_TICKS     4
+
+/* F_CPU comes from the build flags, the default is the 32 MHz of clock.c */
+#ifndef F_CPU
+#define F_CPU 32000000UL
+#endif
+
+/* The timer runs at clkPER / 64 */
+#define FRAME_PER           (F_CPU / 64 / FRAME_FPS - 1)
+
+typedef struct {
+    uint32_t rendered;  // due frames in which at least one disc was redrawn
+    uint32_t skipped;   // due frames in which nothing changed
+    uint32_t late;      // ticks that were missed because a frame took too long
+} frame_stats_t;
+
+void frame_init(void);
+uint8_t frame_due(void);
+void frame_done(uint8_t changed);
+const frame_stats_t *frame_get_stats(void);
+void frame_reset_stats(void);
+void frame_print(void);
+
+#endif /* FRAME_H */
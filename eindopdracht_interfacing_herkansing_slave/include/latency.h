@@ -0,0 +1,33 @@
+/*!
+ * \file    latency.h
+ * \brief   Latency histogram of the telemetry samples, from the moment the
+ *          master stamped a sample until a stage on the slave.
+ *
+ *          The clocks of master and slave are not synchronised, so the
+ *          absolute latency is unknown. The smallest difference between the
+ *          local time and the sample time seen in stage LATENCY_RX is taken
+ *          as the offset between the clocks; the histogram shows the
+ *          latency on top of that fastest sample. Clock drift is ignored.
+ *
+ *          Bucket 0 counts latencies below 256 us, bucket i (i > 0) counts
+ *          latencies from 128 << i up to 256 << i us, the last bucket
+ *          counts everything above.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+#define LATENCY_RX          0   // packet taken from rx_packet by the main loop
+#define LATENCY_FRAME       1   // frame with the sample flushed to the display
+#define LATENCY_STAGES      2
+
+#define LATENCY_BUCKETS     16
+
+void latency_record(uint8_t stage, uint32_t sent, uint32_t local);
+void latency_reset(void);
+void latency_print(void);
+
+#endif /* LATENCY_H */
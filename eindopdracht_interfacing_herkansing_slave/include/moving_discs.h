@@ -17,6 +17,16 @@
 #define X_LINES 160
 #define Y_LINES 128
 
+#define MD_MAX_DISCS 8   /* discs known to the compositor */
+#define MD_MAX_RAD   UCG_DISC_CACHE_MAX_RAD  /* largest radius with a span table */
+#define MD_BOX_MAX_MOVE 8   /* largest move (pixels) that is redrawn as one box */
+
+/* Sub-pixel positions and velocities are Q12.4: 1/16 pixel resolution */
+#define MD_FRAC_BITS 4
+#define MD_FIX(p)    ((md_fix_t) ((p) * (1 << MD_FRAC_BITS)))
+
+typedef int16_t md_fix_t;
+
 
 typedef struct color {
     uint8_t red;
@@ -30,7 +40,14 @@ typedef struct disc {
     ucg_int_t x;
     ucg_int_t y;
     ucg_int_t rad;
+    md_fix_t fx;                    /* position, Q12.4 */
+    md_fix_t fy;
+    md_fix_t vx;                    /* velocity in pixels per step, Q12.4 */
+    md_fix_t vy;
     color_t *color;
+    uint8_t visible;                /* disc has been drawn on the display */
+    uint8_t *sprite;                /* pre-rendered disc (sprite.h), or NULL */
+    uint8_t span[MD_MAX_RAD + 1];   /* half height of the disc per column */
 } disc_t;
 
 
@@ -41,6 +58,10 @@ void md_init_disc(disc_t *disc, ucg_t *ucg, uint8_t nr, ucg_int_t rad,
                color_t *c);
 void md_set_disc_position(disc_t *disc, ucg_int_t x, ucg_int_t y);
 void md_move_disc(disc_t *disc, ucg_int_t, ucg_int_t);
+uint8_t md_move_disc_fixed(disc_t *disc, md_fix_t dx, md_fix_t dy);
+void md_set_disc_velocity(disc_t *disc, md_fix_t vx, md_fix_t vy);
+uint8_t md_step_disc(disc_t *disc, uint8_t steps);
 void md_print_disc_position(disc_t *disc);
+disc_t *md_get_disc(uint8_t z);
 
 #endif /* MOVING_DISCS_H */
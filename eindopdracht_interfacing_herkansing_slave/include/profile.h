@@ -0,0 +1,91 @@
+/*!
+ * \file    profile.h
+ * \brief   Scope timers for the main loop of the slave.
+ *
+ *          A scope is timed with PROFILE_BEGIN(id) ... PROFILE_END(id) in
+ *          the same block. The time is read from a 32 bit cycle counter:
+ *          PROFILE_TIMER_LOW counts clkPER (one count per CPU cycle) and its
+ *          overflow clocks PROFILE_TIMER_HIGH through event channel
+ *          PROFILE_EV_OVF. Per scope the count, minimum, maximum and
+ *          average number of cycles are kept.
+ *
+ *          profile_frame() is called once per due frame. Every
+ *          PROFILE_DUMP_FRAMES frames the results are sent as CSV through
+ *          uartF0_puts and cleared:
+ *
+ *              scope,count,min,max,avg
+ *              parse,12,820,1410,1002
+ *
+ *          The ucglib L90FX and BLIT messages (lines, the tile and sprite
+ *          blits and the disc boxes) and the SPI traffic are timed by
+ *          wrapping the device and com callbacks, see profile_wrap_device()
+ *          and profile_wrap_com(). The SPI traffic has two scopes:
+ *          spi_queue is the time the CPU spends in the com callback, which
+ *          only copies the bytes into spi_dma unless it has to wait for a
+ *          buffer; spi_dma runs from the first transfer queued on an idle
+ *          bus until the last one is shifted out, ended by the
+ *          spi_dma_on_idle() callback. A callback of the application has
+ *          to be passed through profile_wrap_idle(), because it replaces
+ *          the one of the profiler.
+ *
+ *          Without PROFILE defined all macros are empty and the wrappers
+ *          return the callback itself, so nothing is compiled in.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdint.h>
+#include "ucglib/csrc/ucg.h"
+#include "spi_dma.h"
+
+/* Uncomment to enable the profiling */
+//#define PROFILE
+
+#define PROFILE_TIMER_LOW   TCD0
+#define PROFILE_TIMER_HIGH  TCD1
+#define PROFILE_EV_OVF      EVSYS.CH2MUX
+
+#define PROFILE_DUMP_FRAMES 128
+
+/* Scope ids */
+#define PROF_PARSE      0
+#define PROF_DISC1      1
+#define PROF_DISC2      2
+#define PROF_DISC3      3
+#define PROF_DISC4      4
+#define PROF_L90FX      5
+#define PROF_SPI_QUEUE  6
+#define PROF_FRAME      7
+#define PROF_BLIT       8
+#define PROF_SPI_DMA    9
+#define PROF_SCOPES     10
+
+#ifdef PROFILE
+
+void profile_init(void);
+uint32_t profile_now(void);
+void profile_add(uint8_t id, uint32_t cycles);
+void profile_frame(void);
+ucg_dev_fnptr profile_wrap_device(ucg_dev_fnptr device_cb);
+ucg_com_fnptr profile_wrap_com(ucg_com_fnptr com_cb);
+spi_dma_callback_t profile_wrap_idle(spi_dma_callback_t cb);
+
+#define PROFILE_BEGIN(id)   uint32_t profile_start_##id = profile_now()
+#define PROFILE_END(id)     profile_add(id, profile_now() - profile_start_##id)
+
+#else
+
+#define profile_init()
+#define profile_frame()
+#define profile_wrap_device(cb)   (cb)
+#define profile_wrap_com(cb)      (cb)
+#define profile_wrap_idle(cb)     (cb)
+
+#define PROFILE_BEGIN(id)
+#define PROFILE_END(id)
+
+#endif /* PROFILE */
+
+#endif /* PROFILE_H */
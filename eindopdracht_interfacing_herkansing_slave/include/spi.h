@@ -11,9 +11,35 @@
 #define SPI_MISO_bm PIN6_bm
 #define SPI_SCK_bm  PIN7_bm
 
+/* Uncomment to count the bytes and chip select edges on the bus */
+//#define SPI_STATS
+
+typedef struct {
+    uint32_t bytes;
+    uint32_t cs_edges;
+} spi_stats_t;
+
 void spi_init(void);
 uint8_t spi_read_write(uint8_t);
 void spi_write(uint8_t data);
-void spi_write_block(uint8_t *data, uint16_t len);
+void spi_write_block(const uint8_t *data, uint16_t len);
+
+/*
+ * Transaction mode: spi_begin asserts chip select and keeps it asserted
+ * until spi_end, so all bytes in between are sent back-to-back. Outside
+ * a transaction every write selects and deselects the slave itself.
+ */
+void spi_begin(void);
+void spi_end(void);
+void spi_select(void);
+void spi_deselect(void);
+
+#ifdef SPI_STATS
+void spi_count_bytes(uint32_t n);
+void spi_get_stats(spi_stats_t *stats);
+void spi_reset_stats(void);
+#else
+#define spi_count_bytes(n)
+#endif
 
 #endif /* SPI_H */
@@ -0,0 +1,46 @@
+#ifndef SPI_DMA_H
+#define SPI_DMA_H
+
+#include <stdint.h>
+
+/*
+ * DMA transmit engine for the display bus (SPID). A transfer is started
+ * and the call returns immediately, the bytes are clocked out by DMA
+ * channel 0 which is triggered by the SPI interrupt flag. The data is
+ * copied into a buffer of the driver, so the caller may reuse its buffer
+ * right away.
+ *
+ * There are SPI_DMA_BUFS buffers in a ring: while one is sent the next
+ * transfers are copied into the others and queued, the interrupt starts
+ * the next one when the first one is shifted out. A write only waits when
+ * all buffers are in use. ucglib sends a native blit in chunks of
+ * SPI_DMA_BUF_SIZE, so a whole tile of tiles.c (16 x 16 pixels in RGB565,
+ * 512 bytes) is queued without waiting and the next tile can be rendered
+ * while it is sent.
+ * Everything that changes the CD or CS line, or writes SPI DATA itself,
+ * has to call spi_dma_wait() first; spi_dma_end() ends the transaction
+ * after the queued transfers without waiting for them.
+ *
+ * ucg_com_xmega_cb only talks to the display through these functions, so
+ * a host build can link its own implementation of this interface instead
+ * of src/spi_dma.c (host/spi_dma_host.c).
+ */
+
+#define SPI_DMA_CH        DMA.CH0
+#define SPI_DMA_CH_vect   DMA_CH0_vect
+#define SPI_DMA_SPI_vect  SPID_INT_vect
+#define SPI_DMA_BUF_SIZE  48        // multiple of 2 and 3 for the repeats
+#define SPI_DMA_BUFS      12        // 11 for a tile of 512 bytes, and one more
+
+// Called from the interrupt when all queued transfers are shifted out
+typedef void (*spi_dma_callback_t)(void);
+
+void spi_dma_init(void);
+void spi_dma_on_idle(spi_dma_callback_t cb);
+void spi_dma_write(const uint8_t *data, uint16_t len);
+void spi_dma_repeat(const uint8_t *pattern, uint8_t size, uint16_t count);
+void spi_dma_end(void);
+uint8_t spi_dma_busy(void);
+void spi_dma_wait(void);
+
+#endif /* SPI_DMA_H */
@@ -0,0 +1,67 @@
+/*!
+ * \file    sprite.h
+ * \brief   RAM sprites of the discs in the pixel format of the display.
+ *
+ *          Every disc up to SPRITE_MAX_RAD gets a sprite from a static pool
+ *          when it is initialised: the disc on a black square, rendered
+ *          once from its span table and color. When a disc moves and no
+ *          other disc is near, moving_discs composes the box around the
+ *          old and new position from the sprite (clear the box, copy the
+ *          sprite lines) and sends it with one ucg_DrawNativeBlit.
+ *
+ *          The sprites work with and without the tile renderer (TILES in
+ *          tiles.h). With the tiles a move that is blitted from a sprite
+ *          does not mark any tile; the discs that are near each other are
+ *          still composited in the tiles.
+ *
+ *          All memory is static: SPRITE_RAM_BYTES, 4778 bytes in RGB565.
+ *          The sizes are printed while compiling sprite.c and the total is
+ *          checked against SPRITE_RAM_BUDGET.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#ifndef SPRITE_H
+#define SPRITE_H
+
+#include <stdint.h>
+#include "moving_discs.h"
+
+/* Comment out to draw without sprites; -DSPRITES_OFF does the same */
+#ifndef SPRITES_OFF
+#define SPRITES
+#endif
+
+#define SPRITE_COUNT        4   // sprites in the pool, one per ball
+#define SPRITE_MAX_RAD      10  // largest radius with a sprite
+#define SPRITE_MAX_MOVE     4   // largest move per frame (pixels) that is blitted
+
+#ifdef UCGLIB_PIXEL_16BIT
+#define SPRITE_BPP          2   // RGB565
+#else
+#define SPRITE_BPP          3   // 18 bit, one byte per color
+#endif
+
+#define SPRITE_SIZE         (2 * SPRITE_MAX_RAD + 1)
+#define SPRITE_BYTES        (SPRITE_SIZE * SPRITE_SIZE * SPRITE_BPP)
+#define SPRITE_BOX_SIZE     (SPRITE_SIZE + SPRITE_MAX_MOVE)
+#define SPRITE_BOX_BYTES    (SPRITE_BOX_SIZE * SPRITE_BOX_SIZE * SPRITE_BPP)
+#define SPRITE_RAM_BYTES    (SPRITE_COUNT * SPRITE_BYTES + SPRITE_BOX_BYTES)
+
+/* Part of the 16 KB SRAM of the ATxmega256A3U the sprites may use */
+#define SPRITE_RAM_BUDGET   8192
+
+void sprite_pack(const color_t *c, uint8_t *p);
+
+#ifdef SPRITES
+
+uint8_t *sprite_create(disc_t *disc);
+uint8_t sprite_blit(disc_t *disc, ucg_int_t bx, ucg_int_t by, ucg_int_t w, ucg_int_t h);
+
+#else
+
+#define sprite_create(disc)                 NULL
+#define sprite_blit(disc, bx, by, w, h)     0
+
+#endif /* SPRITES */
+
+#endif /* SPRITE_H */
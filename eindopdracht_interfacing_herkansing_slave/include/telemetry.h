@@ -0,0 +1,114 @@
+/*!
+ * \file    telemetry.h
+ * \brief   Binary packet with a batch of accelerometer samples, sent from
+ *          the master to the slave over the nRF24L01+.
+ *
+ *          Layout (multi-byte fields are little endian):
+ *
+ *          | byte  | field     | type     |                                 |
+ *          |-------|-----------|----------|---------------------------------|
+ *          | 0     | version   | uint8_t  | TELEMETRY_VERSION               |
+ *          | 1     | count     | uint8_t  | samples in the packet, 1..3     |
+ *          | 2-3   | seq       | uint16_t | sequence number of sample 0     |
+ *          | 4-7   | timestamp | uint32_t | time of sample 0 in microseconds|
+ *          | 8-9   | period    | uint16_t | microseconds between samples    |
+ *          | 10-   | samples   |          | count times x, y, z             |
+ *
+ *          Every sample is x, y and z as int16_t in Q4.11 g. Q4.11 has 11
+ *          fractional bits: 1 g is 2048, the range is -16 g up to
+ *          16 g - 1/2048 g, which covers every range of the accelerometer.
+ *          The samples of a packet have consecutive sequence numbers, sample
+ *          i has number seq + i and was taken at timestamp + i * period.
+ *          The period is the mean over the packet, 0 for a single sample.
+ *          Three samples fit in the 32 byte payload of the radio.
+ *
+ *          The slave answers in the acknowledge payload of the radio:
+ *
+ *          | byte  | field     | type     |                                 |
+ *          |-------|-----------|----------|---------------------------------|
+ *          | 0     | version   | uint8_t  | TELEMETRY_VERSION               |
+ *          | 1-2   | received  | uint16_t | packets received by the slave   |
+ *
+ *          The slave loads the acknowledge payload after it has received a
+ *          packet, so it travels with the acknowledge of the next packet.
+ *
+ *          Compact packet (TELEMETRY_VERSION_DELTA): the same header, then
+ *          sample 0 as absolute x, y, z like above, then for every next
+ *          sample the change of x, y and z from the sample before it:
+ *
+ *          | byte  | field     | type     |                                 |
+ *          |-------|-----------|----------|---------------------------------|
+ *          | 0     | version   | uint8_t  | TELEMETRY_VERSION_DELTA         |
+ *          | 1     | count     | uint8_t  | samples in the packet, 1..6     |
+ *          | 2-9   |           |          | seq, timestamp and period       |
+ *          | 10-15 | sample 0  |          | x, y, z as int16_t              |
+ *          | 16-   | deltas    |          | count - 1 times dx, dy, dz      |
+ *
+ *          A delta is taken modulo 2^16, zig-zag coded (0, -1, 1, -2, ...
+ *          become 0, 1, 2, 3, ...) and written as a varint: 7 bits per
+ *          byte, low bits first, the top bit set when another byte
+ *          follows. A change of up to 63 (about 31 mg) takes one byte, any
+ *          change at most three. So the deltas of a 32 byte payload hold
+ *          TELEMETRY_DELTA_MIN_BATCH (2) samples in the worst case and
+ *          TELEMETRY_DELTA_MAX_BATCH (6) when the signal changes slowly,
+ *          twice the fixed packet. The encoder puts in as many samples as
+ *          fit, and writes a fixed packet when that holds more, so it never
+ *          sends fewer than TELEMETRY_MAX_BATCH (3) samples of a batch.
+ *          Decoding reads at most len bytes and stops at the first
+ *          malformed delta.
+ * \version 2.3
+ * \date    16-10-2026
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+#define TELEMETRY_VERSION       4
+#define TELEMETRY_HEADER_SIZE   10
+#define TELEMETRY_SAMPLE_SIZE   6
+#define TELEMETRY_MAX_SIZE      32  // payload of the radio
+#define TELEMETRY_MAX_BATCH     ((TELEMETRY_MAX_SIZE - TELEMETRY_HEADER_SIZE) / TELEMETRY_SAMPLE_SIZE)
+#define TELEMETRY_SIZE(n)       (TELEMETRY_HEADER_SIZE + (n) * TELEMETRY_SAMPLE_SIZE)
+#define TELEMETRY_ACK_SIZE      3
+
+#define TELEMETRY_VERSION_DELTA     5
+#define TELEMETRY_DELTA_HEADER_SIZE TELEMETRY_SIZE(1)
+#define TELEMETRY_DELTA_MAX_BYTES   3   // varint bytes of one delta at most
+#define TELEMETRY_DELTA_MAX_BATCH   (1 + (TELEMETRY_MAX_SIZE - TELEMETRY_DELTA_HEADER_SIZE) / 3)
+#define TELEMETRY_DELTA_MIN_BATCH   (1 + (TELEMETRY_MAX_SIZE - TELEMETRY_DELTA_HEADER_SIZE) / \
+                                     (3 * TELEMETRY_DELTA_MAX_BYTES))
+
+/* Room for the samples of any packet */
+#define TELEMETRY_MAX_SAMPLES   TELEMETRY_DELTA_MAX_BATCH
+
+/* Air time of a packet of len bytes with its acknowledge, see telemetry_airtime_us() */
+#define TELEMETRY_AIRTIME_US(len) \
+    (4 * ((8 * (1 + 5 + (len) + 2) + 9) + (8 * (1 + 5 + 2) + 9)) + 2 * 130)
+
+#define TELEMETRY_Q             11
+#define TELEMETRY_ONE_G         (1 << TELEMETRY_Q)
+
+#define TELEMETRY_OK            0
+#define TELEMETRY_ERR_LENGTH    1
+#define TELEMETRY_ERR_VERSION   2
+
+typedef struct {
+    uint16_t seq;
+    uint32_t timestamp;     // microseconds
+    int16_t x;              // Q4.11 g
+    int16_t y;              // Q4.11 g
+    int16_t z;              // Q4.11 g
+} telemetry_sample_t;
+
+uint8_t telemetry_encode(const telemetry_sample_t *s, uint8_t count,
+                         uint8_t *buf, uint8_t size);
+uint8_t telemetry_encode_delta(const telemetry_sample_t *s, uint8_t count,
+                               uint8_t *buf, uint8_t size, uint8_t *used);
+uint8_t telemetry_decode(telemetry_sample_t *s, uint8_t max, uint8_t *count,
+                         const uint8_t *buf, uint8_t len);
+uint8_t telemetry_encode_ack(uint16_t received, uint8_t *buf, uint8_t size);
+uint8_t telemetry_decode_ack(uint16_t *received, const uint8_t *buf, uint8_t len);
+uint16_t telemetry_airtime_us(uint8_t len);
+
+#endif /* TELEMETRY_H */
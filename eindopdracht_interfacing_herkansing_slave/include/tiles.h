@@ -0,0 +1,68 @@
+/*!
+ * \file    tiles.h
+ * \brief   Tile based renderer for the discs.
+ *
+ *          The 160x128 screen is divided in tiles of TILE_W x TILE_H
+ *          pixels. Moving a disc only marks the area of the old and the new
+ *          disc as dirty (tiles_mark()); per tile the bounding box of the
+ *          dirty area is kept. tiles_flush() is called once per frame and
+ *          rasterizes every dirty area in a RAM buffer of one tile: black
+ *          background, then all discs from bottom to top. The area is sent
+ *          with one ucg_DrawNativeBlit. Overlapping discs are composited
+ *          in RAM, so nothing is drawn twice and nothing flickers. When the
+ *          display does not take the blit (the area is not inside the clip
+ *          box) the area is drawn line by line instead.
+ *
+ *          Only the discs are rendered in the tiles. Text that is drawn
+ *          with ucglib directly is not known to the renderer and will be
+ *          overwritten by a dirty area.
+ *
+ *          A disc that moves with no other disc near is blitted from its
+ *          sprite (SPRITES in sprite.h) and does not mark any tile.
+ *
+ *          Without TILES defined moving_discs draws every move directly
+ *          (sprite, compositor or ucg_DrawDiscInBox) and tiles_flush() is
+ *          empty.
+ *
+ *          All memory is static: one tile buffer and the dirty areas,
+ *          TILES_RAM_BYTES in total, checked against TILES_RAM_BUDGET
+ *          while compiling.
+ * \version 1.3
+ * \date    16-10-2026
+ */
+#ifndef TILES_H
+#define TILES_H
+
+#include <stdint.h>
+#include "moving_discs.h"
+#include "sprite.h"
+
+/* Comment out to draw every move directly; -DTILES_OFF does the same */
+#ifndef TILES_OFF
+#define TILES
+#endif
+
+#define TILE_W          16
+#define TILE_H          16
+#define TILES_X         (X_LINES / TILE_W)
+#define TILES_Y         (Y_LINES / TILE_H)
+
+#define TILE_BPP        SPRITE_BPP  // pixel format of the display, see sprite_pack()
+
+#define TILES_RAM_BYTES (TILE_W * TILE_H * TILE_BPP + TILES_X * TILES_Y * 4)
+
+/* Part of the 16 KB SRAM of the ATxmega256A3U the tiles may use */
+#define TILES_RAM_BUDGET 2048
+
+#ifdef TILES
+
+void tiles_mark(ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t h);
+void tiles_flush(ucg_t *ucg);
+
+#else
+
+#define tiles_flush(ucg)
+
+#endif /* TILES */
+
+#endif /* TILES_H */
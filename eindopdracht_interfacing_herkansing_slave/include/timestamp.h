@@ -0,0 +1,27 @@
+/*!
+ * \file    timestamp.h
+ * \brief   Free-running 32 bit timestamp in microseconds.
+ *
+ *          Event channel TIMESTAMP_EV_CLK carries the peripheral clock
+ *          divided by 32 (1 MHz at 32 MHz) to TIMESTAMP_LOW, which counts
+ *          the low 16 bits. Its overflow is passed on event channel
+ *          TIMESTAMP_EV_OVF to TIMESTAMP_HIGH, which counts the high 16
+ *          bits. No interrupts are used. The counter wraps after about
+ *          71.6 minutes.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#ifndef TIMESTAMP_H
+#define TIMESTAMP_H
+
+#include <stdint.h>
+
+#define TIMESTAMP_LOW       TCC0
+#define TIMESTAMP_HIGH      TCC1
+#define TIMESTAMP_EV_CLK    EVSYS.CH0MUX
+#define TIMESTAMP_EV_OVF    EVSYS.CH1MUX
+
+void timestamp_init(void);
+uint32_t timestamp_now(void);
+
+#endif /* TIMESTAMP_H */
@@ -165,6 +165,7 @@ ucg_int_t ucg_dev_hx8352c_18x240x400(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ili9486_18x320x480(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ili9163_18x128x128(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_st7735_18x128x160(ucg_t *ucg, ucg_int_t msg, void *data);
+ucg_int_t ucg_dev_st7735_16x128x160(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_pcf8833_16x132x132(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ld50t6160_18x160x128_samsung(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ssd1331_18x96x64_univision(ucg_t *ucg, ucg_int_t msg, void *data);
@@ -195,6 +196,7 @@ ucg_int_t ucg_ext_hx8352c_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_ili9486_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_ili9163_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_st7735_18(ucg_t *ucg, ucg_int_t msg, void *data);
+ucg_int_t ucg_ext_st7735_16(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_pcf8833_16(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_ld50t6160_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_ext_ssd1331_18(ucg_t *ucg, ucg_int_t msg, void *data);
@@ -212,6 +214,7 @@ ucg_int_t ucg_dev_ic_hx8352c_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_ili9486_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_ili9163_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_st7735_18(ucg_t *ucg, ucg_int_t msg, void *data);
+ucg_int_t ucg_dev_ic_st7735_16(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_pcf8833_16(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_ld50t6160_18(ucg_t *ucg, ucg_int_t msg, void *data);
 ucg_int_t ucg_dev_ic_ssd1331_18(ucg_t *ucg, ucg_int_t msg, void *data);   /* actually this display only has 65k colors */
@@ -274,6 +277,10 @@ struct _ucg_arg_t
   ucg_int_t pixel_skip;		/* within the "bitmap" skip the specified number of pixel with the bit. pixel_skip is always <= 7 */
   ucg_color_t rgb[4];			/* start and end color for L90SE , two more colors for the gradient box */
   ucg_ccs_t ccs_line[3];		/* color component sliders used by L90SE */
+  ucg_int_t rows;			/* number of lines of len pixel, used by UCG_MSG_DRAW_BLIT */
+  uint8_t blit_mode;		/* UCG_BLIT_MASK or UCG_BLIT_NATIVE */
+  const uint8_t *mask;		/* UCG_BLIT_MASK: first and last pixel in color idx 0 per line */
+  const uint8_t *native;	/* UCG_BLIT_NATIVE: rows*len pixel in the format of the display, line by line */
 };
 
 #define UCG_FONT_HEIGHT_MODE_TEXT 0
@@ -465,6 +472,14 @@ struct _ucg_t
 //#define UCG_MSG_DRAW_L90RL 24	/* not yet implemented */
 /* draw  bit pattern with foreground (idx 1) and background (idx 0) color */
 //#define UCG_MSG_DRAW_L90BF 25	 /* can be commented, used by ucg_DrawBitmapLine */
+/* 
+  draw arg.rows lines of arg.len pixel in one go, used by ucg_DrawMaskBlit and ucg_DrawNativeBlit
+  the lines go into direction arg.dir, the next line is one step into direction (arg.dir+1)&3
+  a device returns 0 if it did not draw the blit, the caller then draws it line by line
+*/
+#define UCG_MSG_DRAW_BLIT 26
+#define UCG_BLIT_MASK 1
+#define UCG_BLIT_NATIVE 2
 
 
 #define UCG_COM_STATUS_MASK_POWER 8
@@ -579,6 +594,7 @@ void ucg_DrawL90TCWithArg(ucg_t *ucg);
 void ucg_DrawL90BFWithArg(ucg_t *ucg);
 void ucg_DrawL90SEWithArg(ucg_t *ucg);
 /* void ucg_DrawL90RLWithArg(ucg_t *ucg); */
+ucg_int_t ucg_DrawBlitWithArg(ucg_t *ucg);
 
 /*================================================*/
 /* ucg_init.c */
@@ -615,6 +631,12 @@ void ucg_DrawFrame(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t
 void ucg_DrawRFrame(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t h, ucg_int_t r);
 
 
+/*================================================*/
+/* ucg_blit.c */
+void ucg_DrawMaskBlit(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t len, ucg_int_t rows, ucg_int_t dir, const uint8_t *mask);
+ucg_int_t ucg_DrawNativeBlit(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t h, const uint8_t *native);
+
+
 /*================================================*/
 /* ucg_circle.c */
 #define UCG_DRAW_UPPER_RIGHT 0x01
@@ -622,7 +644,14 @@ void ucg_DrawRFrame(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t
 #define UCG_DRAW_LOWER_LEFT 0x04
 #define UCG_DRAW_LOWER_RIGHT  0x08
 #define UCG_DRAW_ALL (UCG_DRAW_UPPER_RIGHT|UCG_DRAW_UPPER_LEFT|UCG_DRAW_LOWER_RIGHT|UCG_DRAW_LOWER_LEFT)
+/* span tables of discs up to this radius are cached, larger discs use the octant method */
+#define UCG_DISC_CACHE_MAX_RAD 15
+#define UCG_DISC_CACHE_SIZE 4
+/* widest box of ucg_DrawDiscInBox */
+#define UCG_DISC_BOX_MAX_W 48
+const uint8_t *ucg_GetDiscSpan(ucg_int_t rad);
 void ucg_DrawDisc(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, uint8_t option);
+ucg_int_t ucg_DrawDiscInBox(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, ucg_int_t bx, ucg_int_t by, ucg_int_t w, ucg_int_t h);
 void ucg_DrawCircle(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, uint8_t option);
 
 /*================================================*/
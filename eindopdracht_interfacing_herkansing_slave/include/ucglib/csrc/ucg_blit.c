@@ -0,0 +1,136 @@
+/*
+
+  ucg_blit.c
+
+  Draw a box of pixel with one device message (UCG_MSG_DRAW_BLIT)
+  
+  Universal uC Color Graphics Library
+  
+  Copyright (c) 2013, olikraus@gmail.com
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without modification, 
+  are permitted provided that the following conditions are met:
+
+  * Redistributions of source code must retain the above copyright notice, this list 
+    of conditions and the following disclaimer.
+    
+  * Redistributions in binary form must reproduce the above copyright notice, this 
+    list of conditions and the following disclaimer in the documentation and/or other 
+    materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND 
+  CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, 
+  INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF 
+  MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE 
+  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR 
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT 
+  NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; 
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER 
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, 
+  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) 
+  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF 
+  ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.  
+  
+
+*/
+
+#include "ucg.h"
+
+/* move x/y n pixel into direction dir */
+static void ucg_blit_step(ucg_int_t *x, ucg_int_t *y, ucg_int_t n, ucg_int_t dir)
+{
+  switch(dir & 3)
+  {
+    case 0: *x += n; break;
+    case 1: *y += n; break;
+    case 2: *x -= n; break;
+    default: *y -= n; break;
+  }
+}
+
+/*
+  Fallback for devices without UCG_MSG_DRAW_BLIT: draw one line of a mask
+  blit into direction dir, color idx 0 from first to last, color idx 1 for
+  the other pixel
+*/
+static void ucg_blit_mask_line(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t len, ucg_int_t dir, ucg_int_t first, ucg_int_t last)
+{
+  ucg_int_t fx, fy;
+  
+  if ( first > last || first >= len )
+  {
+    ucg_Draw90Line(ucg, x, y, len, dir, 1);
+    return;
+  }
+  if ( last >= len )
+    last = len-1;
+  if ( first > 0 )
+    ucg_Draw90Line(ucg, x, y, first, dir, 1);
+  fx = x; fy = y;
+  ucg_blit_step(&fx, &fy, first, dir);
+  ucg_Draw90Line(ucg, fx, fy, last-first+1, dir, 0);
+  if ( last < len-1 )
+  {
+    fx = x; fy = y;
+    ucg_blit_step(&fx, &fy, last+1, dir);
+    ucg_Draw90Line(ucg, fx, fy, len-1-last, dir, 1);
+  }
+}
+
+static ucg_int_t ucg_blit_with_arg(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t len, ucg_int_t rows, ucg_int_t dir, uint8_t mode)
+{
+  ucg->arg.pixel.pos.x = x;
+  ucg->arg.pixel.pos.y = y;
+  ucg->arg.len = len;
+  ucg->arg.rows = rows;
+  ucg->arg.dir = dir;
+  ucg->arg.blit_mode = mode;
+  return ucg_DrawBlitWithArg(ucg);
+}
+
+/*
+  Draw rows lines of len pixel, starting at x/y. The lines go into
+  direction dir (0: right, 1: down, 2: left, 3: up), every next line starts
+  one pixel further into direction (dir+1)&3: with dir 0 the box is sent
+  line by line from the top, with dir 1 column by column from the right.
+  For every line "mask" contains two bytes: the first and the last pixel
+  that are drawn with color idx 0. All other pixel of the box are drawn
+  with color idx 1. A line with first > last only has color idx 1. The box
+  is sent as one address window if the device supports it and the box is
+  completely inside the clip box, otherwise it is drawn line by line.
+*/
+void ucg_DrawMaskBlit(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t len, ucg_int_t rows, ucg_int_t dir, const uint8_t *mask)
+{
+  ucg_int_t j;
+  
+  if ( len <= 0 || rows <= 0 )
+    return;
+  
+  ucg->arg.mask = mask;
+  if ( ucg_blit_with_arg(ucg, x, y, len, rows, dir, UCG_BLIT_MASK) != 0 )
+    return;
+  
+  for( j = 0; j < rows; j++ )
+  {
+    ucg_blit_mask_line(ucg, x, y, len, dir, mask[2*j], mask[2*j+1]);
+    ucg_blit_step(&x, &y, 1, dir+1);
+  }
+}
+
+/*
+  Draw a box of w x h pixel at x/y. "native" contains w*h pixel, line by
+  line, already in the format the display expects (for example 2 bytes
+  RGB565 per pixel). There is no fallback: returns 0 if the device could not
+  draw the box in one address window, the caller has to draw it in another
+  way.
+*/
+ucg_int_t ucg_DrawNativeBlit(ucg_t *ucg, ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t h, const uint8_t *native)
+{
+  if ( w <= 0 || h <= 0 )
+    return 1;
+  
+  ucg->arg.native = native;
+  return ucg_blit_with_arg(ucg, x, y, w, h, 0, UCG_BLIT_NATIVE);
+}
@@ -198,8 +198,127 @@ static void ucg_draw_disc(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad,
   }
 }
 
+/*
+  Disc span cache: for every cached radius the half height of the disc per
+  column offset, span[0..rad]. The table is filled by the same midpoint
+  algorithm as ucg_draw_disc (the union of the octant lines per column),
+  so the shape is identical. Entries are replaced round robin.
+*/
+
+typedef struct _ucg_disc_span_t
+{
+  ucg_int_t rad;
+  uint8_t span[UCG_DISC_CACHE_MAX_RAD+1];
+} ucg_disc_span_t;
+
+static ucg_disc_span_t ucg_disc_cache[UCG_DISC_CACHE_SIZE];
+static uint8_t ucg_disc_cache_used = 0;
+static uint8_t ucg_disc_cache_next = 0;
+
+static void ucg_fill_disc_span(ucg_disc_span_t *e, ucg_int_t rad)
+{
+  ucg_int_t f;
+  ucg_int_t ddF_x;
+  ucg_int_t ddF_y;
+  ucg_int_t x;
+  ucg_int_t y;
+  uint8_t i;
+
+  for( i = 0; i <= UCG_DISC_CACHE_MAX_RAD; i++ )
+    e->span[i] = 0;
+
+  f = 1;
+  f -= rad;
+  ddF_x = 1;
+  ddF_y = 0;
+  ddF_y -= rad;
+  ddF_y *= 2;
+  x = 0;
+  y = rad;
+
+  for(;;)
+  {
+    if ( e->span[x] < y ) e->span[x] = y;
+    if ( e->span[y] < x ) e->span[y] = x;
+    if ( x >= y )
+      break;
+    if (f >= 0) 
+    {
+      y--;
+      ddF_y += 2;
+      f += ddF_y;
+    }
+    x++;
+    ddF_x += 2;
+    f += ddF_x;
+  }
+  e->rad = rad;
+}
+
+/* returns the span table of a disc with radius rad, or NULL if rad is out of range */
+const uint8_t *ucg_GetDiscSpan(ucg_int_t rad)
+{
+  ucg_disc_span_t *e;
+  uint8_t i;
+
+  if ( rad < 0 || rad > UCG_DISC_CACHE_MAX_RAD )
+    return NULL;
+
+  for( i = 0; i < ucg_disc_cache_used; i++ )
+    if ( ucg_disc_cache[i].rad == rad )
+      return ucg_disc_cache[i].span;
+
+  e = ucg_disc_cache + ucg_disc_cache_next;
+  if ( ucg_disc_cache_used < UCG_DISC_CACHE_SIZE )
+    ucg_disc_cache_used++;
+  ucg_disc_cache_next++;
+  if ( ucg_disc_cache_next >= UCG_DISC_CACHE_SIZE )
+    ucg_disc_cache_next = 0;
+  ucg_fill_disc_span(e, rad);
+  return e->span;
+}
+
+/*
+  Draw the disc column by column from left to right, one vertical line per
+  column. Unlike the octant method no pixel is written twice.
+*/
+static void ucg_draw_disc_spans(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, const uint8_t *span, uint8_t option)
+{
+  ucg_int_t dx;
+  ucg_int_t h;
+  ucg_int_t top;
+  ucg_int_t bot;
+  uint8_t upper;
+  uint8_t lower;
+
+  for( dx = -rad; dx <= rad; dx++ )
+  {
+    upper = 0;
+    lower = 0;
+    if ( dx <= 0 )
+    {
+      upper |= option & UCG_DRAW_UPPER_LEFT;
+      lower |= option & UCG_DRAW_LOWER_LEFT;
+    }
+    if ( dx >= 0 )
+    {
+      upper |= option & UCG_DRAW_UPPER_RIGHT;
+      lower |= option & UCG_DRAW_LOWER_RIGHT;
+    }
+    if ( upper == 0 && lower == 0 )
+      continue;
+    
+    h = span[dx < 0 ? -dx : dx];
+    top = upper ? y0 - h : y0;
+    bot = lower ? y0 + h : y0;
+    ucg_DrawVLine(ucg, x0+dx, top, bot-top+1);
+  }
+}
+
 void ucg_DrawDisc(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, uint8_t option)
 {
+  const uint8_t *span;
+  
   /* check for bounding box */
   /*
   {
@@ -215,7 +334,63 @@ void ucg_DrawDisc(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, uint8_t
   }
   */
   
-  /* draw disc */
-  ucg_draw_disc(ucg, x0, y0, rad, option);
+  /* draw disc, from the span cache if the radius fits */
+  span = ucg_GetDiscSpan(rad);
+  if ( span != NULL )
+    ucg_draw_disc_spans(ucg, x0, y0, rad, span, option);
+  else
+    ucg_draw_disc(ucg, x0, y0, rad, option);
 }
 
+
+/*
+  Draw the box bx/by/w/h in color idx 1 with the disc x0/y0/rad in color
+  idx 0 on top. The box is sent column by column, from the right, as one
+  mask blit: a single address window on devices that support
+  UCG_MSG_DRAW_BLIT, the pixel of the disc are taken from the span cache.
+  Returns 0 if nothing was drawn, because the radius is not cached or the
+  box is wider than UCG_DISC_BOX_MAX_W.
+*/
+ucg_int_t ucg_DrawDiscInBox(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0, ucg_int_t rad, ucg_int_t bx, ucg_int_t by, ucg_int_t w, ucg_int_t h)
+{
+  uint8_t mask[2*UCG_DISC_BOX_MAX_W];
+  const uint8_t *span;
+  ucg_int_t j;
+  ucg_int_t dx;
+  ucg_int_t top;
+  ucg_int_t bot;
+  
+  span = ucg_GetDiscSpan(rad);
+  if ( span == NULL || w > UCG_DISC_BOX_MAX_W || h > 255 )
+    return 0;
+  if ( w <= 0 || h <= 0 )
+    return 1;
+  
+  for( j = 0; j < w; j++ )
+  {
+    dx = bx + w - 1 - j - x0;
+    if ( dx < 0 )
+      dx = -dx;
+    top = 1;
+    bot = 0;
+    if ( dx <= rad )
+    {
+      top = y0 - span[dx] - by;
+      bot = y0 + span[dx] - by;
+      if ( top < 0 )
+	top = 0;
+      if ( bot >= h )
+	bot = h-1;
+    }
+    if ( top > bot )
+    {
+      top = 1;
+      bot = 0;
+    }
+    mask[2*j] = top;
+    mask[2*j+1] = bot;
+  }
+  
+  ucg_DrawMaskBlit(ucg, bx + w - 1, by, h, w, 1, mask);
+  return 1;
+}
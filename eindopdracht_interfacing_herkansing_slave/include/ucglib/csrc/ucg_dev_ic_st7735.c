@@ -42,6 +42,12 @@ static ucg_int_t ucg_handle_st7735_l90fx(ucg_t *ucg);
 static ucg_int_t ucg_handle_st7735_l90tc(ucg_t *ucg);
 #endif
 static ucg_int_t ucg_handle_st7735_l90se(ucg_t *ucg);
+static ucg_int_t ucg_handle_st7735_16_l90fx(ucg_t *ucg);
+#ifdef UCG_MSG_DRAW_L90TC
+static ucg_int_t ucg_handle_st7735_16_l90tc(ucg_t *ucg);
+#endif
+static ucg_int_t ucg_handle_st7735_16_l90se(ucg_t *ucg);
+static ucg_int_t ucg_handle_st7735_blit(ucg_t *ucg, uint8_t bytes_per_pixel);
 
 const ucg_pgm_uint8_t ucg_st7735_set_pos_seq[] = 
 {
@@ -125,34 +131,44 @@ const ucg_pgm_uint8_t ucg_st7735_set_pos_dir3_seq[] =
   UCG_END()
 };
 
+/*
+  Start a line at arg.pixel.pos into direction arg.dir: memory access
+  control, address window and RAMWR of the sequence for that direction.
+  Used by the 18 and the 16 bit mode.
+*/
+static void ucg_st7735_set_pos_dir(ucg_t *ucg)
+{
+  ucg_int_t tmp;
+  switch(ucg->arg.dir)
+  {
+    case 0: 
+      ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir0_seq);	
+      break;
+    case 1: 
+      ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir1_seq);	
+      break;
+    case 2: 
+      tmp = ucg->arg.pixel.pos.x;
+      ucg->arg.pixel.pos.x = 127-tmp;
+      ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir2_seq);	
+      ucg->arg.pixel.pos.x = tmp;
+      break;
+    case 3: 
+    default: 
+      tmp = ucg->arg.pixel.pos.y;
+      ucg->arg.pixel.pos.y = 159-tmp;
+      ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir3_seq);	
+      ucg->arg.pixel.pos.y = tmp;
+      break;
+  }
+}
+
 static ucg_int_t ucg_handle_st7735_l90fx(ucg_t *ucg)
 {
   uint8_t c[3];
-  ucg_int_t tmp;
   if ( ucg_clip_l90fx(ucg) != 0 )
   {
-    switch(ucg->arg.dir)
-    {
-      case 0: 
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir0_seq);	
-	break;
-      case 1: 
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir1_seq);	
-	break;
-      case 2: 
-	tmp = ucg->arg.pixel.pos.x;
-	ucg->arg.pixel.pos.x = 127-tmp;
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir2_seq);	
-	ucg->arg.pixel.pos.x = tmp;
-	break;
-      case 3: 
-      default: 
-	tmp = ucg->arg.pixel.pos.y;
-	ucg->arg.pixel.pos.y = 159-tmp;
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir3_seq);	
-	ucg->arg.pixel.pos.y = tmp;
-	break;
-    }
+    ucg_st7735_set_pos_dir(ucg);
     c[0] = ucg->arg.pixel.rgb.color[0];
     c[1] = ucg->arg.pixel.rgb.color[1];
     c[2] = ucg->arg.pixel.rgb.color[2];
@@ -262,7 +278,6 @@ static ucg_int_t ucg_handle_st7735_l90se(ucg_t *ucg)
 {
   uint8_t i;
   uint8_t c[3];
-  ucg_int_t tmp;
   
   /* Setup ccs for l90se. This will be updated by ucg_clip_l90se if required */
   
@@ -276,28 +291,7 @@ static ucg_int_t ucg_handle_st7735_l90se(ucg_t *ucg)
   if ( ucg_clip_l90se(ucg) != 0 )
   {
     ucg_int_t k;
-    switch(ucg->arg.dir)
-    {
-      case 0: 
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir0_seq);	
-	break;
-      case 1: 
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir1_seq);	
-	break;
-      case 2: 
-	tmp = ucg->arg.pixel.pos.x;
-	ucg->arg.pixel.pos.x = 127-tmp;
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir2_seq);	
-	ucg->arg.pixel.pos.x = tmp;
-	break;
-      case 3: 
-      default: 
-	tmp = ucg->arg.pixel.pos.y;
-	ucg->arg.pixel.pos.y = 159-tmp;
-	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_dir3_seq);	
-	ucg->arg.pixel.pos.y = tmp;
-	break;
-    }
+    ucg_st7735_set_pos_dir(ucg);
     
     for( k = 0; k < ucg->arg.len; k++ )
     {
@@ -355,6 +349,8 @@ ucg_int_t ucg_dev_ic_st7735_18(ucg_t *ucg, ucg_int_t msg, void *data)
       //ucg_handle_l90fx(ucg, ucg_dev_ic_st7735_18);
       ucg_handle_st7735_l90fx(ucg);
       return 1;
+    case UCG_MSG_DRAW_BLIT:
+      return ucg_handle_st7735_blit(ucg, 3);
 #ifdef UCG_MSG_DRAW_L90TC
     case UCG_MSG_DRAW_L90TC:
       //ucg_handle_l90tc(ucg, ucg_dev_ic_st7735_18);
@@ -388,4 +384,388 @@ ucg_int_t ucg_ext_st7735_18(ucg_t *ucg, ucg_int_t msg, void *data)
       break;
   }
   return 1;
-}
\ No newline at end of file
+}
+
+
+/*
+  16 bit (RGB565) mode, COLMOD 0x05
+  
+  Same address window handling as the 18 bit mode, but each pixel is
+  transferred as two bytes: RRRRRGGG GGGBBBBB
+*/
+
+static void ucg_st7735_16_pack(const uint8_t *rgb, uint8_t *c)
+{
+  c[0] = (rgb[0] & 0x0f8) | (rgb[1] >> 5);
+  c[1] = ((rgb[1] << 3) & 0x0e0) | (rgb[2] >> 3);
+}
+
+static ucg_int_t ucg_handle_st7735_16_l90fx(ucg_t *ucg)
+{
+  uint8_t c[2];
+  if ( ucg_clip_l90fx(ucg) != 0 )
+  {
+    ucg_st7735_set_pos_dir(ucg);
+    ucg_st7735_16_pack(ucg->arg.pixel.rgb.color, c);
+    ucg_com_SendRepeat2Bytes(ucg, ucg->arg.len, c);
+    ucg_com_SetCSLineStatus(ucg, 1);		/* disable chip */
+    return 1;
+  }
+  return 0;
+}
+
+#ifdef UCG_MSG_DRAW_L90TC
+/* with CmdDataSequence */ 
+static ucg_int_t ucg_handle_st7735_16_l90tc(ucg_t *ucg)
+{
+  if ( ucg_clip_l90tc(ucg) != 0 )
+  {
+    uint8_t buf[16];
+    uint8_t c[2];
+    ucg_int_t dx, dy;
+    ucg_int_t i;
+    unsigned char pixmap;
+    uint8_t bitcnt;
+    ucg_com_SetCSLineStatus(ucg, 0);		/* enable chip */
+    ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_seq);	
+
+    buf[0] = 0x001;	// change to 0 (cmd mode)
+    buf[1] = 0x02a;	// set x
+    buf[2] = 0x002;	// change to 1 (arg mode)
+    buf[3] = 0x000;	// upper part x
+    buf[4] = 0x000;	// no change
+    buf[5] = 0x000;	// will be overwritten by x value
+    buf[6] = 0x001;	// change to 0 (cmd mode)
+    buf[7] = 0x02c;	// write data
+    buf[8] = 0x002;	// change to 1 (data mode)
+    buf[9] = 0x000;	// RRRRRGGG
+    buf[10] = 0x000;	// no change
+    buf[11] = 0x000;	// GGGBBBBB
+    
+    switch(ucg->arg.dir)
+    {
+      case 0: 
+	dx = 1; dy = 0; 
+	buf[1] = 0x02a;	// set x
+	break;
+      case 1: 	
+	dx = 0; dy = 1; 
+        buf[1] = 0x02b;	// set y
+	break;
+      case 2: 
+	dx = -1; dy = 0; 
+        buf[1] = 0x02a;	// set x
+	break;
+      case 3: 
+      default:
+	dx = 0; dy = -1; 
+        buf[1] = 0x02b;	// set y
+	break;
+    }
+    pixmap = ucg_pgm_read(ucg->arg.bitmap);
+    bitcnt = ucg->arg.pixel_skip;
+    pixmap <<= bitcnt;
+    ucg_st7735_16_pack(ucg->arg.pixel.rgb.color, c);
+    buf[9] = c[0];
+    buf[11] = c[1];
+    
+    for( i = 0; i < ucg->arg.len; i++ )
+    {
+      if ( (pixmap & 128) != 0 )
+      {
+	if ( (ucg->arg.dir&1) == 0 )
+	{
+	  buf[5] = ucg->arg.pixel.pos.x;
+	}
+	else
+	{
+	  buf[3] = ucg->arg.pixel.pos.y>>8;
+	  buf[5] = ucg->arg.pixel.pos.y&255;
+	}
+	ucg_com_SendCmdDataSequence(ucg, 6, buf, 0);
+      }
+      pixmap<<=1;
+      ucg->arg.pixel.pos.x+=dx;
+      ucg->arg.pixel.pos.y+=dy;
+      bitcnt++;
+      if ( bitcnt >= 8 )
+      {
+	ucg->arg.bitmap++;
+	pixmap = ucg_pgm_read(ucg->arg.bitmap);
+	bitcnt = 0;
+      }
+    }
+    ucg_com_SetCSLineStatus(ucg, 1);		/* disable chip */
+    return 1;
+  }
+  return 0;
+}
+#endif
+
+static ucg_int_t ucg_handle_st7735_16_l90se(ucg_t *ucg)
+{
+  uint8_t i;
+  uint8_t rgb[3];
+  uint8_t c[2];
+  
+  /* Setup ccs for l90se. This will be updated by ucg_clip_l90se if required */
+  
+  for ( i = 0; i < 3; i++ )
+  {
+    ucg_ccs_init(ucg->arg.ccs_line+i, ucg->arg.rgb[0].color[i], ucg->arg.rgb[1].color[i], ucg->arg.len);
+  }
+  
+  /* check if the line is visible */
+  
+  if ( ucg_clip_l90se(ucg) != 0 )
+  {
+    ucg_int_t k;
+    ucg_st7735_set_pos_dir(ucg);
+    
+    for( k = 0; k < ucg->arg.len; k++ )
+    {
+      rgb[0] = ucg->arg.ccs_line[0].current;
+      rgb[1] = ucg->arg.ccs_line[1].current; 
+      rgb[2] = ucg->arg.ccs_line[2].current;
+      ucg_st7735_16_pack(rgb, c);
+      ucg_com_SendRepeat2Bytes(ucg, 1, c);
+      ucg_ccs_step(ucg->arg.ccs_line+0);
+      ucg_ccs_step(ucg->arg.ccs_line+1);
+      ucg_ccs_step(ucg->arg.ccs_line+2);
+    }
+    ucg_com_SetCSLineStatus(ucg, 1);		/* disable chip */
+    return 1;
+  }
+  return 0;
+}
+
+/*
+  UCG_MSG_DRAW_BLIT
+  
+  All lines of the blit are written into one address window. The memory
+  access control (0x036: MY 0x080, MX 0x040, MV 0x020) is chosen so that
+  the RAM address counter follows the lines into direction arg.dir and
+  continues with the next line into direction (arg.dir+1)&3:
+  
+    dir 0: +x, then +y		0x000
+    dir 1: +y, then -x		0x060 (exchanged, x mirrored)
+    dir 2: -x, then -y		0x0c0 (x and y mirrored)
+    dir 3: -y, then +x		0x0a0 (exchanged, y mirrored)
+  
+  ucg_st7735_blit_madctl and ucg_st7735_ram_pos are the only place of this
+  mapping. MX and MY mirror the panel in the same way as the line
+  sequences of direction 2 and 3 above. MV exchanges the column and the
+  row address (ST7735 datasheet, memory data access control). The mapping
+  is checked in every direction against the controller emulation of
+  host/ucglib_host.c by the disc_box case of host/render_test.c. To check
+  it on a panel, draw that picture: in each rotation the box of
+  ucg_DrawDiscInBox has to line up with ucg_DrawDisc at the same place.
+  
+  Returns 0 if the blit is not completely inside the clip box, the caller
+  will then draw it line by line (UCG_BLIT_NATIVE: in its own way).
+*/
+
+static const uint8_t ucg_st7735_blit_madctl[4] = { 0x000, 0x060, 0x0c0, 0x0a0 };
+
+/* RAM column and row of panel pixel x/y with the memory access control of direction dir */
+static void ucg_st7735_ram_pos(ucg_int_t dir, ucg_int_t x, ucg_int_t y, ucg_int_t *col, ucg_int_t *row)
+{
+  uint8_t madctl = ucg_st7735_blit_madctl[dir & 3];
+  
+  if ( madctl & 0x040 )
+    x = 127-x;
+  if ( madctl & 0x080 )
+    y = 159-y;
+  if ( madctl & 0x020 )
+  {
+    *col = y;
+    *row = x;
+  }
+  else
+  {
+    *col = x;
+    *row = y;
+  }
+}
+
+static void ucg_st7735_blit_pack(const uint8_t *rgb, uint8_t *c, uint8_t bytes_per_pixel)
+{
+  if ( bytes_per_pixel == 2 )
+  {
+    ucg_st7735_16_pack(rgb, c);
+  }
+  else
+  {
+    c[0] = rgb[0];
+    c[1] = rgb[1];
+    c[2] = rgb[2];
+  }
+}
+
+static void ucg_st7735_blit_repeat(ucg_t *ucg, ucg_int_t cnt, uint8_t *c, uint8_t bytes_per_pixel)
+{
+  if ( cnt <= 0 )
+    return;
+  if ( bytes_per_pixel == 2 )
+    ucg_com_SendRepeat2Bytes(ucg, cnt, c);
+  else
+    ucg_com_SendRepeat3Bytes(ucg, cnt, c);
+}
+
+static ucg_int_t ucg_st7735_set_blit_window(ucg_t *ucg)
+{
+  uint8_t buf[36];
+  uint8_t i;
+  uint8_t madctl;
+  ucg_int_t x0, y0, x1, y1;
+  ucg_int_t cs, ce, rs, re;
+  
+  /* first and last pixel of the blit */
+  x0 = ucg->arg.pixel.pos.x;
+  y0 = ucg->arg.pixel.pos.y;
+  x1 = x0;
+  y1 = y0;
+  switch(ucg->arg.dir & 3)
+  {
+    case 0: x1 += ucg->arg.len - 1; y1 += ucg->arg.rows - 1; break;
+    case 1: y1 += ucg->arg.len - 1; x1 -= ucg->arg.rows - 1; break;
+    case 2: x1 -= ucg->arg.len - 1; y1 -= ucg->arg.rows - 1; break;
+    default: y1 -= ucg->arg.len - 1; x1 += ucg->arg.rows - 1; break;
+  }
+  
+  if ( (x0 < x1 ? x0 : x1) < ucg->clip_box.ul.x || (x0 > x1 ? x0 : x1) >= ucg->clip_box.ul.x + ucg->clip_box.size.w )
+    return 0;
+  if ( (y0 < y1 ? y0 : y1) < ucg->clip_box.ul.y || (y0 > y1 ? y0 : y1) >= ucg->clip_box.ul.y + ucg->clip_box.size.h )
+    return 0;
+  
+  /* the window in RAM addresses */
+  madctl = ucg_st7735_blit_madctl[ucg->arg.dir & 3];
+  ucg_st7735_ram_pos(ucg->arg.dir, x0, y0, &cs, &rs);
+  ucg_st7735_ram_pos(ucg->arg.dir, x1, y1, &ce, &re);
+  
+  i = 0;
+  buf[i++] = 0x001; buf[i++] = 0x036;	/* memory access control */
+  buf[i++] = 0x002; buf[i++] = madctl;
+  if ( madctl != 0 )
+  {
+    buf[i++] = 0x001; buf[i++] = 0x036;	/* it seems that this command needs to be sent twice */
+    buf[i++] = 0x002; buf[i++] = madctl;
+  }
+  buf[i++] = 0x001; buf[i++] = 0x02a;	/* column address */
+  buf[i++] = 0x002; buf[i++] = cs>>8;
+  buf[i++] = 0x000; buf[i++] = cs&255;
+  buf[i++] = 0x000; buf[i++] = ce>>8;
+  buf[i++] = 0x000; buf[i++] = ce&255;
+  buf[i++] = 0x001; buf[i++] = 0x02b;	/* row address */
+  buf[i++] = 0x002; buf[i++] = rs>>8;
+  buf[i++] = 0x000; buf[i++] = rs&255;
+  buf[i++] = 0x000; buf[i++] = re>>8;
+  buf[i++] = 0x000; buf[i++] = re&255;
+  buf[i++] = 0x001; buf[i++] = 0x02c;	/* write to RAM */
+  
+  ucg_com_SetCSLineStatus(ucg, 0);		/* enable chip */
+  ucg_com_SendCmdDataSequence(ucg, i/2, buf, 0);
+  ucg_com_SetCDLineStatus(ucg, 1);		/* data mode */
+  return 1;
+}
+
+static ucg_int_t ucg_handle_st7735_blit(ucg_t *ucg, uint8_t bytes_per_pixel)
+{
+  uint8_t buf[48];
+  uint8_t fg[3];
+  uint8_t bg[3];
+  uint8_t n;
+  uint16_t cnt;
+  ucg_int_t j, first, last;
+  const uint8_t *m;
+  
+  if ( ucg->arg.len <= 0 || ucg->arg.rows <= 0 )
+    return 1;
+  if ( ucg_st7735_set_blit_window(ucg) == 0 )
+    return 0;
+  
+  if ( ucg->arg.blit_mode == UCG_BLIT_MASK )
+  {
+    ucg_st7735_blit_pack(ucg->arg.rgb[0].color, fg, bytes_per_pixel);
+    ucg_st7735_blit_pack(ucg->arg.rgb[1].color, bg, bytes_per_pixel);
+    m = ucg->arg.mask;
+    for( j = 0; j < ucg->arg.rows; j++ )
+    {
+      first = m[0];
+      last = m[1];
+      m += 2;
+      if ( last >= ucg->arg.len )
+	last = ucg->arg.len-1;
+      if ( first > last )
+      {
+	ucg_st7735_blit_repeat(ucg, ucg->arg.len, bg, bytes_per_pixel);
+	continue;
+      }
+      ucg_st7735_blit_repeat(ucg, first, bg, bytes_per_pixel);
+      ucg_st7735_blit_repeat(ucg, last-first+1, fg, bytes_per_pixel);
+      ucg_st7735_blit_repeat(ucg, ucg->arg.len-1-last, bg, bytes_per_pixel);
+    }
+  }
+  else if ( ucg->arg.blit_mode == UCG_BLIT_NATIVE )
+  {
+    /* already in the display format, send it in chunks of at most 48 bytes */
+    m = ucg->arg.native;
+    cnt = (uint16_t)ucg->arg.len * (uint16_t)ucg->arg.rows * bytes_per_pixel;
+    while( cnt > 0 )
+    {
+      n = cnt > sizeof(buf) ? sizeof(buf) : cnt;
+      ucg_com_SendString(ucg, n, m);
+      m += n;
+      cnt -= n;
+    }
+  }
+  ucg_com_SetCSLineStatus(ucg, 1);		/* disable chip */
+  return 1;
+}
+
+ucg_int_t ucg_dev_ic_st7735_16(ucg_t *ucg, ucg_int_t msg, void *data)
+{
+  switch(msg)
+  {
+    case UCG_MSG_DRAW_PIXEL:
+      if ( ucg_clip_is_pixel_visible(ucg) !=0 )
+      {
+	uint8_t c[2];
+	ucg_com_SendCmdSeq(ucg, ucg_st7735_set_pos_seq);	
+	ucg_st7735_16_pack(ucg->arg.pixel.rgb.color, c);
+	ucg_com_SendRepeat2Bytes(ucg, 1, c);
+	ucg_com_SetCSLineStatus(ucg, 1);		/* disable chip */
+      }
+      return 1;
+    case UCG_MSG_DRAW_L90FX:
+      ucg_handle_st7735_16_l90fx(ucg);
+      return 1;
+    case UCG_MSG_DRAW_BLIT:
+      return ucg_handle_st7735_blit(ucg, 2);
+#ifdef UCG_MSG_DRAW_L90TC
+    case UCG_MSG_DRAW_L90TC:
+      ucg_handle_st7735_16_l90tc(ucg);
+      return 1;	
+#endif /* UCG_MSG_DRAW_L90TC */
+#ifdef UCG_MSG_DRAW_L90BF
+     case UCG_MSG_DRAW_L90BF:
+      ucg_handle_l90bf(ucg, ucg_dev_ic_st7735_16);
+      return 1;
+#endif /* UCG_MSG_DRAW_L90BF */
+  }
+  /* power up/down and dimension are the same as for the 18 bit mode */
+  return ucg_dev_ic_st7735_18(ucg, msg, data);  
+}
+
+ucg_int_t ucg_ext_st7735_16(ucg_t *ucg, ucg_int_t msg, void *data)
+{
+  (void)data;
+
+  switch(msg)
+  {
+    case UCG_MSG_DRAW_L90SE:
+      ucg_handle_st7735_16_l90se(ucg);
+      break;
+  }
+  return 1;
+}
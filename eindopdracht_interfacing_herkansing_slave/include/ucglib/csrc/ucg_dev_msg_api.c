@@ -122,6 +122,12 @@ void ucg_DrawL90SEWithArg(ucg_t *ucg)
   ucg->device_cb(ucg, UCG_MSG_DRAW_L90SE, &(ucg->arg));
 }
 
+/* returns 0 if the device did not draw the blit */
+ucg_int_t ucg_DrawBlitWithArg(ucg_t *ucg)
+{
+  return ucg->device_cb(ucg, UCG_MSG_DRAW_BLIT, &(ucg->arg));
+}
+
 /*
 void ucg_DrawL90RLWithArg(ucg_t *ucg)
 {
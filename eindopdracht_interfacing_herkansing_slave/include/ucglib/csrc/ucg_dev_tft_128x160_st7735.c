@@ -109,3 +109,34 @@ ucg_int_t ucg_dev_st7735_18x128x160(ucg_t *ucg, ucg_int_t msg, void *data)
   /* all other messages are handled by the controller procedures */
   return ucg_dev_ic_st7735_18(ucg, msg, data);  
 }
+
+/* same module, but the controller runs in 16 bit (RGB565) pixel mode */
+static const ucg_pgm_uint8_t ucg_tft_128x160_st7735_16_init_seq[] = {
+  UCG_CS(0),					/* enable chip */
+  UCG_C11(0x03a, 0x005), 		/* set pixel format to 16 bit */
+  UCG_CS(1),					/* disable chip */
+  UCG_END(),					/* end of sequence */
+};
+
+ucg_int_t ucg_dev_st7735_16x128x160(ucg_t *ucg, ucg_int_t msg, void *data)
+{
+  switch(msg)
+  {
+    case UCG_MSG_DEV_POWER_UP:
+      /* 1. Setup the com interface and the module (18 bit mode) */
+      if ( ucg_dev_st7735_18x128x160(ucg, msg, data) == 0 )
+	return 0;
+
+      /* 2. Switch the pixel format to 16 bit */
+      ucg_com_SendCmdSeq(ucg, ucg_tft_128x160_st7735_16_init_seq);
+      
+      return 1;
+      
+    case UCG_MSG_DEV_POWER_DOWN:
+    case UCG_MSG_GET_DIMENSION:
+      return ucg_dev_st7735_18x128x160(ucg, msg, data);  
+  }
+  
+  /* all other messages are handled by the 16 bit controller procedures */
+  return ucg_dev_ic_st7735_16(ucg, msg, data);  
+}
@@ -109,6 +109,7 @@ static ucg_int_t ucg_dev_rotate90(ucg_t *ucg, ucg_int_t msg, void *data)
     case UCG_MSG_DRAW_L90BF:
 #endif /* UCG_MSG_DRAW_L90BF */
     case UCG_MSG_DRAW_L90SE:
+    case UCG_MSG_DRAW_BLIT:
     //case UCG_MSG_DRAW_L90RL:
       ucg->arg.dir+=1;
       ucg->arg.dir&=3;
@@ -174,6 +175,7 @@ static ucg_int_t ucg_dev_rotate180(ucg_t *ucg, ucg_int_t msg, void *data)
     case UCG_MSG_DRAW_L90BF:
 #endif /* UCG_MSG_DRAW_L90BF */
     case UCG_MSG_DRAW_L90SE:
+    case UCG_MSG_DRAW_BLIT:
     //case UCG_MSG_DRAW_L90RL:
       ucg->arg.dir+=2;
       ucg->arg.dir&=3;
@@ -239,6 +241,7 @@ static ucg_int_t ucg_dev_rotate270(ucg_t *ucg, ucg_int_t msg, void *data)
     case UCG_MSG_DRAW_L90BF:
 #endif /* UCG_MSG_DRAW_L90BF */
     case UCG_MSG_DRAW_L90SE:
+    case UCG_MSG_DRAW_BLIT:
 //    case UCG_MSG_DRAW_L90RL:
       ucg->arg.dir+=3;
       ucg->arg.dir&=3;
@@ -213,6 +213,8 @@ static ucg_int_t ucg_dev_scale2x2(ucg_t *ucg, ucg_int_t msg, void *data)
       ucg->arg.dir = dir;
       return 1;
 #endif 
+    case UCG_MSG_DRAW_BLIT:
+      return 0;	/* not scaled, the caller draws line by line */
   }
   return ucg->scale_chain_device_cb(ucg, msg, data);  
 }
@@ -7,6 +7,18 @@
 #define UCGLIB_RST_bm PIN3_bm
 #define UCGLIB_CD_bm  PIN2_bm
 
+/* Pixel format of the ST7735: 16 bit (RGB565) sends 2 bytes per pixel, */
+/* 18 bit sends 3 bytes per pixel. Comment out for the 18 bit mode.     */
+#define UCGLIB_PIXEL_16BIT
+
+#ifdef UCGLIB_PIXEL_16BIT
+#define UCGLIB_DEV_ST7735 ucg_dev_st7735_16x128x160
+#define UCGLIB_EXT_ST7735 ucg_ext_st7735_16
+#else
+#define UCGLIB_DEV_ST7735 ucg_dev_st7735_18x128x160
+#define UCGLIB_EXT_ST7735 ucg_ext_st7735_18
+#endif
+
 int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data);
 
 #endif /* UCGLIB_XMEGA_H */
@@ -0,0 +1,87 @@
+/*!
+ * \file    frame.c
+ * \brief   Frame pacing of the slave render loop, see frame.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "frame.h"
+
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+#if FRAME_PER > 0xFFFF || FRAME_PER < 1
+#error "FRAME_FPS out of range for the frame timer"
+#endif
+
+static volatile uint8_t frame_ticks = 0;
+static frame_stats_t frame_stats;
+
+void frame_init(void)
+{
+    FRAME_TIMER.CTRLB = TC_WGMODE_NORMAL_gc;
+    FRAME_TIMER.PER = FRAME_PER;
+    FRAME_TIMER.CNT = 0;
+    FRAME_TIMER.INTCTRLA = TC_OVFINTLVL_LO_gc;
+    FRAME_TIMER.CTRLA = TC_CLKSEL_DIV64_gc;
+}
+
+/*
+ * Number of frame ticks since the previous due frame, 0 when no frame is
+ * due. The ticks are taken over with interrupts off.
+ */
+uint8_t frame_due(void)
+{
+    uint8_t ticks;
+    uint8_t sreg = SREG;
+
+    cli();
+    ticks = frame_ticks;
+    frame_ticks = 0;
+    SREG = sreg;
+
+    if (ticks > 1) {
+        frame_stats.late += ticks - 1;
+    }
+    if (ticks > FRAME_MAX_TICKS) {
+        ticks = FRAME_MAX_TICKS;
+    }
+
+    return ticks;
+}
+
+/* Called after a due frame, changed is non-zero when anything was redrawn */
+void frame_done(uint8_t changed)
+{
+    if (changed) {
+        frame_stats.rendered++;
+    } else {
+        frame_stats.skipped++;
+    }
+}
+
+const frame_stats_t *frame_get_stats(void)
+{
+    return &frame_stats;
+}
+
+void frame_reset_stats(void)
+{
+    frame_stats.rendered = 0;
+    frame_stats.skipped = 0;
+    frame_stats.late = 0;
+}
+
+// Print the counters on the serial port (stdout is serialF0)
+void frame_print(void)
+{
+    printf("frames: %d fps rendered=%lu skipped=%lu late=%lu\n", FRAME_FPS,
+           frame_stats.rendered, frame_stats.skipped, frame_stats.late);
+}
+
+ISR(FRAME_TIMER_VEC)
+{
+    if (frame_ticks < 0xFF) {
+        frame_ticks++;
+    }
+}
@@ -0,0 +1,108 @@
+/*!
+ * \file    latency.c
+ * \brief   Latency histogram of the telemetry samples, see latency.h.
+ * \version 1.0
+ * \date    16-10-2026
+ */
+#include "latency.h"
+
+#include <stdio.h>
+
+typedef struct {
+    uint16_t bucket[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t sum;
+    uint32_t max;
+} latency_hist_t;
+
+static const char *latency_names[LATENCY_STAGES] = { "rx", "frame" };
+
+static latency_hist_t latency_hist[LATENCY_STAGES];
+static uint32_t latency_offset;
+static uint8_t latency_have_offset = 0;
+
+static uint8_t latency_bucket(uint32_t us)
+{
+    uint8_t i = 0;
+
+    us >>= 8;
+    while (us != 0 && i < LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        i++;
+    }
+
+    return i;
+}
+
+/*
+ * Record a sample that was stamped at sent (master clock) and reached
+ * the stage at local (slave clock), both in microseconds.
+ */
+void latency_record(uint8_t stage, uint32_t sent, uint32_t local)
+{
+    latency_hist_t *h;
+    uint32_t diff = local - sent;
+    uint32_t us;
+
+    if (stage >= LATENCY_STAGES) {
+        return;
+    }
+
+    if (stage == LATENCY_RX &&
+            (!latency_have_offset || (int32_t) (diff - latency_offset) < 0)) {
+        latency_offset = diff;
+        latency_have_offset = 1;
+    }
+    if (!latency_have_offset || (int32_t) (diff - latency_offset) < 0) {
+        us = 0;
+    } else {
+        us = diff - latency_offset;
+    }
+
+    h = &latency_hist[stage];
+    if (h->bucket[latency_bucket(us)] < UINT16_MAX) {
+        h->bucket[latency_bucket(us)]++;
+    }
+    h->count++;
+    h->sum += us;
+    if (us > h->max) {
+        h->max = us;
+    }
+}
+
+void latency_reset(void)
+{
+    uint8_t s, i;
+
+    for (s = 0; s < LATENCY_STAGES; s++) {
+        for (i = 0; i < LATENCY_BUCKETS; i++) {
+            latency_hist[s].bucket[i] = 0;
+        }
+        latency_hist[s].count = 0;
+        latency_hist[s].sum = 0;
+        latency_hist[s].max = 0;
+    }
+    latency_have_offset = 0;
+}
+
+// Print the histograms on the serial port (stdout is serialF0)
+void latency_print(void)
+{
+    latency_hist_t *h;
+    uint8_t s, i;
+
+    for (s = 0; s < LATENCY_STAGES; s++) {
+        h = &latency_hist[s];
+        printf("latency %s: n=%lu avg=%lu max=%lu us\n", latency_names[s],
+               h->count, h->count ? h->sum / h->count : 0, h->max);
+        for (i = 0; i < LATENCY_BUCKETS; i++) {
+            if (h->bucket[i] != 0) {
+                if (i < LATENCY_BUCKETS - 1) {
+                    printf("  <%lu us: %u\n", 256UL << i, h->bucket[i]);
+                } else {
+                    printf("  >=%lu us: %u\n", 128UL << i, h->bucket[i]);
+                }
+            }
+        }
+    }
+}
@@ -24,13 +24,81 @@
 #include "nrf24spiXM2.h"
 #include <string.h>
 #include "balls.h"
+#include "telemetry.h"
+#include "timestamp.h"
+#include "latency.h"
+#include "spi_dma.h"
+#include "profile.h"
+#include "frame.h"
+#include "tiles.h"
 
 #define NRF_CHANNEL  76
+#define PLAY_DRIFT_SHIFT  4   // hoe langzaam play_offset omhoog mag lopen
 
 uint8_t rx_packet[128];
 uint8_t master[5] = "MTOSP"; // Master to slave pipe
 uint8_t slave[5] = "STOMP";  // Slave to master pipe
 volatile uint8_t rx_flag;
+volatile uint8_t rx_length;
+uint16_t rx_count = 0;       // ontvangen pakketten, terug naar de master in de ACK
+
+uint32_t frame_sample_time;           // meting in het frame dat naar het display gaat
+volatile uint32_t sent_sample_time;   // meting in het laatste frame dat helemaal is verstuurd
+volatile uint32_t sent_time;          // en wanneer dat klaar was
+volatile uint8_t sent_flag;
+
+// De metingen worden afgespeeld op de klok van de master: een frame op lokale tijd t
+// laat de meting zien van tijd t - play_offset. play_offset is het kleinste verschil
+// tussen de ontvangsttijd en de eerste meting van een pakket, dus bij het snelste
+// pakket begint het afspelen bij de eerste meting en is de laatste aan de beurt als
+// het volgende pakket binnenkomt.
+uint32_t play_offset;
+uint8_t play_synced = 0;
+
+// Past play_offset aan met een pakket dat nu binnen is gekomen. Omlaag gaat direct,
+// omhoog langzaam, zodat een vertraagd pakket het afspelen niet verschuift maar een
+// klok die uit de pas loopt wel wordt bijgehouden.
+static void play_sync(const telemetry_sample_t *first){
+  uint32_t diff = timestamp_now() - first->timestamp;
+
+  if (!play_synced || (int32_t) (diff - play_offset) < 0) {
+    play_offset = diff;
+    play_synced = 1;
+  } else {
+    play_offset += (diff - play_offset) >> PLAY_DRIFT_SHIFT;
+  }
+}
+
+// Kiest de nieuwste meting uit batch die niet na de tijd van dit frame ligt. next is
+// de eerste meting die nog niet is laten zien; metingen die al voorbij zijn worden
+// overgeslagen. Geeft 1 als sample een nieuwe meting is.
+static uint8_t play_sample(const telemetry_sample_t *batch, uint8_t count, uint8_t *next,
+                           telemetry_sample_t *sample){
+  uint32_t play_time = timestamp_now() - play_offset;
+  uint8_t i = *next;
+
+  while (i < count && (int32_t) (batch[i].timestamp - play_time) <= 0) {
+    i++;
+  }
+  if (i == *next) {
+    return 0;
+  }
+  *sample = batch[i - 1];
+  *next = i;
+
+  return 1;
+}
+
+// Zet de data klaar die met de volgende ACK naar de master gaat.
+// Een oude ACK payload die nog niet is verstuurd wordt eerst weggegooid.
+void nrf_load_ack(void){
+  uint8_t ack[TELEMETRY_ACK_SIZE];
+  uint8_t length;
+
+  length = telemetry_encode_ack(rx_count, ack, sizeof(ack));
+  nrfFlushTx();
+  nrfWriteAckPayload(0, ack, length);
+}
 
 // Hier wordt de nrf geinitialiseerd.
 // Deze functie is gebaseerd op het NRF master-slave voorbeeld van Caspar Treijtel.
@@ -44,6 +112,7 @@ void nrf_init(){
   nrfSetChannel(NRF_CHANNEL);
   nrfSetAutoAck(1);
   nrfEnableDynamicPayloads();
+  nrfEnableAckPayload();
   nrfClearInterruptBits();
   nrfFlushRx();
   nrfFlushTx();
@@ -60,18 +129,42 @@ void nrf_init(){
   nrfOpenReadingPipe(0, (uint8_t *) master);
   nrfStartListening();
   nrfPowerUp();
+  nrf_load_ack();
 }
 
-typedef struct {
-  float x;
-  float y;
-} ACCOmgerekend;
+// Berekent de snelheid van een bal uit de versnelling in Q4.11 g, in pixels per
+// frame tick in Q12.4 (zie moving_discs.h). Er wordt naar nul afgerond, zodat links en
+// rechts even snel gaan. Kleine snelheden tellen nu op in plaats van weg te vallen.
+static md_fix_t tilt_velocity(uint8_t weight, int16_t g)
+{
+  return (md_fix_t)(((int32_t) weight * g) / (1 << (TELEMETRY_Q - MD_FRAC_BITS)));
+}
+
+// Zet de snelheid van een bal volgens de meting en verplaats hem over het aantal
+// verstreken frame ticks. Geeft 1 terug als de bal opnieuw is getekend.
+static uint8_t move_ball(disc_t *disc, ball *b, telemetry_sample_t *sample, uint8_t ticks)
+{
+  md_set_disc_velocity(disc, tilt_velocity(b->weight, sample->y), tilt_velocity(b->weight, sample->x));
+  return md_step_disc(disc, ticks);
+}
+
+// Wordt vanuit de DMA interrupt aangeroepen als alle data van het frame naar het
+// display is gestuurd. De latency wordt daarna in de main loop bijgehouden.
+static void frame_sent(void)
+{
+  sent_sample_time = frame_sample_time;
+  sent_time = timestamp_now();
+  sent_flag = 1;
+}
 
 // Hier wordt de ugc library geinitialiseerd.
 // Deze functie is gebaseerd op tft_display_ucg van Caspar Treijtel uit 2023.
 void ucg_init(ucg_t *ucg) {
   ucg_com_fnptr ucg_xmega_func = &ucg_com_xmega_cb;
-  ucg_Init(ucg, ucg_dev_st7735_18x128x160, ucg_ext_st7735_18, ucg_xmega_func);
+  // De pixelmodus (16 of 18 bit) wordt gekozen in ucglib_xmega.h.
+  // Met PROFILE aan (profile.h) worden de device en com callbacks gemeten.
+  ucg_Init(ucg, profile_wrap_device(UCGLIB_DEV_ST7735), UCGLIB_EXT_ST7735,
+           profile_wrap_com(ucg_xmega_func));
 
 }
 
@@ -80,12 +173,19 @@ int main(void){
   //Hier worden alle initialisaties gedaan.
   init_clock();
   init_stream(F_CPU);
+  timestamp_init();
+  profile_init();
+  frame_init();
   clear_screen();
 
-  ACCOmgerekend accelarationG;
-  char full_buffer[32];
-  char x_buffer[16];
-  char y_buffer[16];
+  telemetry_sample_t sample = {0, 0, 0, 0, 0};
+  uint8_t new_sample;
+  uint8_t ticks;
+  uint8_t changed;
+  uint16_t command;
+  telemetry_sample_t batch[TELEMETRY_MAX_SAMPLES];
+  uint8_t batch_count = 0;
+  uint8_t batch_next = 0;
   
   // Hier wordt ucg geinitialiseerd en worden er al direct dingen getekent met de ucg. 
   // Deze functie is gebaseerd op tft_display_ucg van Caspar Treijtel uit 2023.
@@ -118,29 +218,97 @@ int main(void){
   nrf_init();
 
 while (1) { 
-    
   
   if (rx_flag) {
+    PROFILE_BEGIN(PROF_PARSE);
     rx_flag = 0;
 
-    // Hier wordt de ontvangen data van de NRF in uit de string gehaald. 
-    // Dit gebeurd door de ontvangen string naar een buffer te kopieren. 
-    // Daarna wordt deze string gesplitst om de x en y waardes op te kunnen slaan.
-    strncpy(full_buffer, rx_packet, sizeof(full_buffer));
+    // Hier wordt het ontvangen binaire pakket van de NRF uitgepakt.
+    // Een pakket met een verkeerde lengte of versie wordt genegeerd.
+    // Metingen uit een vorig pakket die nog niet aan de beurt waren vervallen.
+    if (telemetry_decode(batch, TELEMETRY_MAX_SAMPLES, &batch_count,
+                         rx_packet, rx_length) == TELEMETRY_OK) {
+      batch_next = 0;
+      play_sync(&batch[0]);
+      latency_record(LATENCY_RX, batch[0].timestamp, timestamp_now());
+    }
+    PROFILE_END(PROF_PARSE);
+
+  }
 
-    strncpy(x_buffer, strtok(full_buffer, ","), sizeof(x_buffer));
-    strncpy(y_buffer, strtok(NULL, ","), sizeof(y_buffer));
+    // De ballen worden alleen bewogen als er een frame tick is geweest (FRAME_FPS in
+    // frame.h), niet elke keer dat de lus rond gaat. Zo blijft de SPI bus vrij als er
+    // toch niets verandert.
+    ticks = frame_due();
+    if (ticks) {
+      PROFILE_BEGIN(PROF_FRAME);
 
-    accelarationG.x = atof(x_buffer);
-    accelarationG.y = atof(y_buffer);
+      // Een pakket bevat meerdere metingen, die worden op hun tijd afgespeeld (zie
+      // play_offset): elk frame de nieuwste meting die niet na de tijd van het frame
+      // ligt. De master meet vaker dan er frames zijn, dus er vallen metingen tussen
+      // de frames weg, maar verspreid over het pakket. Zijn ze allemaal gebruikt,
+      // dan blijft de laatste meting gelden.
+      new_sample = play_sample(batch, batch_count, &batch_next, &sample);
 
-  }
-    
-    // Hier worden alle ballen verplaatst gebaseerd op de versnelling die gemeten is door de master.
-    md_move_disc(&disc1, ball1.weight*accelarationG.y, ball1.weight*accelarationG.x);
-    md_move_disc(&disc2, ball2.weight*accelarationG.y, ball2.weight*accelarationG.x);
-    md_move_disc(&disc3, ball3.weight*accelarationG.y, ball3.weight*accelarationG.x);
-    md_move_disc(&disc4, ball4.weight*accelarationG.y, ball4.weight*accelarationG.x);
+      // Hier worden alle ballen verplaatst gebaseerd op de versnelling die gemeten is door de master.
+      // De verplaatsing is snelheid maal het aantal verstreken ticks.
+      changed = 0;
+      PROFILE_BEGIN(PROF_DISC1);
+      changed |= move_ball(&disc1, &ball1, &sample, ticks);
+      PROFILE_END(PROF_DISC1);
+      PROFILE_BEGIN(PROF_DISC2);
+      changed |= move_ball(&disc2, &ball2, &sample, ticks);
+      PROFILE_END(PROF_DISC2);
+      PROFILE_BEGIN(PROF_DISC3);
+      changed |= move_ball(&disc3, &ball3, &sample, ticks);
+      PROFILE_END(PROF_DISC3);
+      PROFILE_BEGIN(PROF_DISC4);
+      changed |= move_ball(&disc4, &ball4, &sample, ticks);
+      PROFILE_END(PROF_DISC4);
+
+      // Met de tile renderer (tiles.h) worden de ballen nu pas getekend, alle
+      // vier tegelijk en alleen waar iets veranderd is.
+      if (changed) {
+        tiles_flush(&ucg);
+      }
+
+      // Als het beeld met een nieuwe meting helemaal naar het display is gestuurd
+      // wordt de latency van die meting bijgehouden. Er wordt niet op de DMA
+      // gewacht: frame_sent() wordt aangeroepen als de laatste data weg is.
+      if (new_sample) {
+        cli();
+        frame_sample_time = sample.timestamp;
+        sei();
+        spi_dma_on_idle(profile_wrap_idle(frame_sent));
+      }
+      frame_done(changed);
+
+      PROFILE_END(PROF_FRAME);
+      profile_frame();
+    }
+
+    if (sent_flag) {
+      uint32_t sample_time, time;
+
+      cli();
+      sample_time = sent_sample_time;
+      time = sent_time;
+      sent_flag = 0;
+      sei();
+      latency_record(LATENCY_FRAME, sample_time, time);
+    }
+
+    // Via de seriele poort: 'l' print de latency histogrammen, 'f' de getekende en
+    // overgeslagen frames, 'c' wist ze allemaal.
+    command = uartF0_getc();
+    if (command == 'l') {
+      latency_print();
+    } else if (command == 'f') {
+      frame_print();
+    } else if (command == 'c') {
+      latency_reset();
+      frame_reset_stats();
+    }
   }
 }
 
@@ -155,8 +323,13 @@ ISR(NRF24_IRQ_VEC)
 
   if (rx_dr) {
     packet_length = nrfGetDynamicPayloadSize();
+    if (packet_length > sizeof(rx_packet)) {
+      packet_length = sizeof(rx_packet);
+    }
     nrfRead(rx_packet, packet_length);
-    rx_packet[packet_length] = '\0';
+    rx_length = packet_length;
     rx_flag = 1;
+    rx_count++;
+    nrf_load_ack();
   }
 }
\ No newline at end of file
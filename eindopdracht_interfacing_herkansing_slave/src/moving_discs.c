@@ -5,13 +5,56 @@
  *          is used with the ucglib library. The discs can be created with
  *          different colors and radius. The discs can be moved on the
  *          display.
- * \version 0.1
+ *
+ *          Moving a disc only repaints the pixels that change: the
+ *          symmetric difference between the old and the new disc, per
+ *          column. Every disc that is initialised is registered with the
+ *          compositor, so pixels that are uncovered show the disc below
+ *          (or the black background) and discs that are on top of the
+ *          moving disc are left untouched.
+ *
+ *          When no other disc is near, the box around the old and new
+ *          position is instead sent in one blit: from the sprite of the
+ *          disc (sprite.h), or else column by column from the span table
+ *          with ucg_DrawDiscInBox.
+ *
+ *          With the tile renderer (TILES in tiles.h) a move that is not
+ *          blitted from a sprite only marks the old and new disc as dirty;
+ *          tiles_flush() draws them.
+ *
+ *          The position is kept in Q12.4 fixed point, so moves smaller
+ *          than a pixel add up instead of being truncated away. A disc is
+ *          only redrawn when its whole-pixel position changes.
+ * \version 0.6
  * \date    2023-10-02
  */
 #include "moving_discs.h"
 #include <stdlib.h>
+#include <string.h>
+#include "sprite.h"
+#include "tiles.h"
 #include "serialF0.h"
 
+#if 2 * MD_MAX_RAD + 1 + MD_BOX_MAX_MOVE > UCG_DISC_BOX_MAX_W
+#error "MD_BOX_MAX_MOVE is too large for ucg_DrawDiscInBox"
+#endif
+
+/* Discs in drawing order, the last registered disc is on top */
+static disc_t *md_discs[MD_MAX_DISCS];
+static uint8_t md_disc_count = 0;
+
+static void md_register_disc(disc_t *disc);
+static uint8_t md_box_move(disc_t *disc, ucg_int_t ox, ucg_int_t oy);
+#ifndef TILES
+static void md_repaint_move(disc_t *disc, ucg_int_t ox, ucg_int_t oy);
+static uint8_t md_covers(disc_t *disc, ucg_int_t x, ucg_int_t y);
+static uint8_t md_column_pixel(disc_t *disc, uint8_t z, ucg_int_t x, ucg_int_t y);
+static void md_flush_run(disc_t *disc, uint8_t z, uint8_t run,
+                         ucg_int_t x, ucg_int_t y, ucg_int_t len);
+static void md_draw_column(disc_t *disc, uint8_t z, ucg_int_t x,
+                           ucg_int_t ytop, ucg_int_t ybot);
+#endif
+
 color_t *md_create_color(uint8_t r, uint8_t g, uint8_t b)
 {
     color_t *c = (color_t *) malloc(sizeof(color_t));
@@ -37,10 +80,7 @@ disc_t *md_create_disc(ucg_t *ucg, uint8_t nr, ucg_int_t rad, color_t *c)
 {
     disc_t *d = (disc_t *) malloc(sizeof(disc_t));
     if ( d != NULL ) {
-        d->ucg = ucg;
-        d->nr = nr;
-        d->rad = rad;
-        d->color = c;
+        md_init_disc(d, ucg, nr, rad, c);
     }
 
     return d;
@@ -50,10 +90,26 @@ void md_init_disc(disc_t *disc, ucg_t *ucg, uint8_t nr, ucg_int_t rad,
                color_t *c) {
 
     if ( disc != NULL ) {
+        if ( rad > MD_MAX_RAD ) {
+            rad = MD_MAX_RAD;
+        }
         disc->ucg = ucg;
         disc->nr = nr;
         disc->rad = rad;
         disc->color = c;
+        disc->visible = 0;
+        disc->x = 0;
+        disc->y = 0;
+        disc->fx = 0;
+        disc->fy = 0;
+        disc->vx = 0;
+        disc->vy = 0;
+        // The same span table as ucg_DrawDisc, so the compositor produces
+        // exactly the same shape. It is copied: the cache entry of ucglib
+        // is reused when more radii are drawn.
+        memcpy(disc->span, ucg_GetDiscSpan(rad), rad + 1);
+        md_register_disc(disc);
+        disc->sprite = sprite_create(disc);
     }
 }
 
@@ -62,40 +118,321 @@ void md_set_disc_position(disc_t *disc, ucg_int_t x, ucg_int_t y)
     if ( disc != NULL ) {
         disc->x = x;
         disc->y = y;
+        disc->fx = MD_FIX(x);
+        disc->fy = MD_FIX(y);
+    }
+}
+
+void md_set_disc_velocity(disc_t *disc, md_fix_t vx, md_fix_t vy)
+{
+    if ( disc != NULL ) {
+        disc->vx = vx;
+        disc->vy = vy;
     }
 }
 
+/*
+ * Move the disc by its velocity for a number of steps (elapsed frame
+ * ticks). Returns 1 when the disc was redrawn.
+ */
+uint8_t md_step_disc(disc_t *disc, uint8_t steps)
+{
+    return md_move_disc_fixed(disc, (md_fix_t) (disc->vx * steps),
+                              (md_fix_t) (disc->vy * steps));
+}
+
 void md_move_disc(disc_t *disc, ucg_int_t dx, ucg_int_t dy)
 {
-    ucg_int_t xcur, ycur;
-    // Draw black circle
-    xcur = disc->x;
-    ycur = disc->y;
-    ucg_SetColor(disc->ucg, 0, 0, 0, 0);
-    ucg_DrawDisc(disc->ucg, xcur, ycur, disc->rad, UCG_DRAW_ALL);
+    md_move_disc_fixed(disc, MD_FIX(dx), MD_FIX(dy));
+}
+
+/* Returns 1 when the disc was redrawn, 0 when its pixel position is the same */
+uint8_t md_move_disc_fixed(disc_t *disc, md_fix_t dx, md_fix_t dy)
+{
+    ucg_int_t ox, oy;
+
+    ox = disc->x;
+    oy = disc->y;
 
-    // Move new circle
-    disc->x += dx;
-    disc->y += dy;
+    // Move new circle; the pixel position is the whole part of the fixed
+    // point position (an arithmetic shift rounds towards minus infinity)
+    disc->fx += dx;
+    disc->fy += dy;
+    disc->x = disc->fx >> MD_FRAC_BITS;
+    disc->y = disc->fy >> MD_FRAC_BITS;
     if (disc->x > (X_LINES + disc->rad/2)) {
         disc->x = 0;
+        disc->fx = MD_FIX(disc->x);
     } else if (disc->x < 0) {
         disc->x = X_LINES + disc->rad/2;
+        disc->fx = MD_FIX(disc->x);
     }
     if (disc->y > (Y_LINES + disc->rad/2)) {
         disc->y = 0;
+        disc->fy = MD_FIX(disc->y);
     } else if (disc->y < 0) {
         disc->y = Y_LINES + disc->rad/2;
+        disc->fy = MD_FIX(disc->y);
+    }
+
+    if (disc->visible && disc->x == ox && disc->y == oy) {
+        return 0;
+    }
+
+    if (md_box_move(disc, ox, oy)) {
+        disc->visible = 1;
+        return 1;
+    }
+
+#ifdef TILES
+    if (disc->visible) {
+        tiles_mark(ox - disc->rad, oy - disc->rad, 2 * disc->rad + 1, 2 * disc->rad + 1);
     }
-    // Draw new circle
-    ucg_SetColor(disc->ucg, 0,
-                 disc->color->red,
-                 disc->color->green,
-                 disc->color->blue);
-    ucg_DrawDisc(disc->ucg, disc->x, disc->y, disc->rad, UCG_DRAW_ALL);
+    tiles_mark(disc->x - disc->rad, disc->y - disc->rad, 2 * disc->rad + 1, 2 * disc->rad + 1);
+#else
+    md_repaint_move(disc, ox, oy);
+#endif
+    disc->visible = 1;
+
+    return 1;
 }
 
 void md_print_disc_position(disc_t* d)
 {
     printf("Postion disc %d=(%d,%d) ", d->nr, d->x, d->y);
 }
+
+/* Disc number z in drawing order (0 is at the bottom), NULL if there is none */
+disc_t *md_get_disc(uint8_t z)
+{
+    return (z < md_disc_count) ? md_discs[z] : NULL;
+}
+
+static void md_register_disc(disc_t *disc)
+{
+    uint8_t i;
+
+    for (i = 0; i < md_disc_count; i++) {
+        if (md_discs[i] == disc) {
+            return;
+        }
+    }
+    if (md_disc_count < MD_MAX_DISCS) {
+        md_discs[md_disc_count++] = disc;
+    }
+}
+
+/*
+ * Draw the box around the old and new disc in one blit: from the sprite,
+ * or without the tiles column by column from the span table when there is
+ * no sprite or the move is too large for it. Only possible when no other
+ * visible disc is inside the box, because the box is drawn on a black
+ * background. Returns 0 when nothing was drawn.
+ *
+ * With the tiles the box may cover a dirty area of a disc that moved
+ * away earlier in this frame; tiles_flush() draws that area again.
+ */
+static uint8_t md_box_move(disc_t *disc, ucg_int_t ox, ucg_int_t oy)
+{
+    ucg_int_t bx, by, w, h;
+    disc_t *d;
+    uint8_t i;
+
+#ifdef TILES
+    if (disc->sprite == NULL) {
+        return 0;
+    }
+#endif
+    if (disc->visible) {
+        bx = (ox < disc->x ? ox : disc->x) - disc->rad;
+        by = (oy < disc->y ? oy : disc->y) - disc->rad;
+        w = abs(disc->x - ox) + 2 * disc->rad + 1;
+        h = abs(disc->y - oy) + 2 * disc->rad + 1;
+    } else {
+        bx = disc->x - disc->rad;
+        by = disc->y - disc->rad;
+        w = 2 * disc->rad + 1;
+        h = w;
+    }
+    if (w > 2 * disc->rad + 1 + MD_BOX_MAX_MOVE || h > 2 * disc->rad + 1 + MD_BOX_MAX_MOVE) {
+        return 0;
+    }
+
+    for (i = 0; i < md_disc_count; i++) {
+        d = md_discs[i];
+        if (d == disc || !d->visible) {
+            continue;
+        }
+        if (d->x + d->rad >= bx && d->x - d->rad < bx + w &&
+                d->y + d->rad >= by && d->y - d->rad < by + h) {
+            return 0;
+        }
+    }
+
+    if (disc->sprite != NULL && sprite_blit(disc, bx, by, w, h)) {
+        return 1;
+    }
+
+#ifdef TILES
+    return 0;
+#else
+    ucg_SetColor(disc->ucg, 0, disc->color->red, disc->color->green, disc->color->blue);
+    ucg_SetColor(disc->ucg, 1, 0, 0, 0);
+    return ucg_DrawDiscInBox(disc->ucg, disc->x, disc->y, disc->rad, bx, by, w, h) != 0;
+#endif
+}
+
+#ifndef TILES
+
+/*
+ * Repaint the symmetric difference of the old disc at ox/oy and the new
+ * disc per column, composited with the discs below and on top of it.
+ */
+static void md_repaint_move(disc_t *disc, ucg_int_t ox, ucg_int_t oy)
+{
+    ucg_int_t x, xmin, xmax;
+    ucg_int_t otop, obot, ntop, nbot, ho, hn;
+    uint8_t z;
+
+    for (z = 0; z < md_disc_count && md_discs[z] != disc; z++)
+        ;
+
+    xmin = (ox < disc->x ? ox : disc->x) - disc->rad;
+    xmax = (ox > disc->x ? ox : disc->x) + disc->rad;
+    if (xmin < 0) {
+        xmin = 0;
+    }
+    if (xmax > X_LINES - 1) {
+        xmax = X_LINES - 1;
+    }
+
+    for (x = xmin; x <= xmax; x++) {
+        ho = x - ox;
+        hn = x - disc->x;
+        if (ho < 0) ho = -ho;
+        if (hn < 0) hn = -hn;
+
+        // An empty span has top > bottom
+        otop = 1; obot = 0;
+        if (disc->visible && ho <= disc->rad) {
+            otop = oy - disc->span[ho];
+            obot = oy + disc->span[ho];
+        }
+        ntop = 1; nbot = 0;
+        if (hn <= disc->rad) {
+            ntop = disc->y - disc->span[hn];
+            nbot = disc->y + disc->span[hn];
+        }
+
+        if (otop > obot) {
+            md_draw_column(disc, z, x, ntop, nbot);
+        } else if (ntop > nbot || nbot < otop || ntop > obot) {
+            md_draw_column(disc, z, x, otop, obot);
+            md_draw_column(disc, z, x, ntop, nbot);
+        } else {
+            // Overlapping spans: only the two ends differ
+            if (ntop < otop) {
+                md_draw_column(disc, z, x, ntop, otop - 1);
+            } else {
+                md_draw_column(disc, z, x, otop, ntop - 1);
+            }
+            if (nbot > obot) {
+                md_draw_column(disc, z, x, obot + 1, nbot);
+            } else {
+                md_draw_column(disc, z, x, nbot + 1, obot);
+            }
+        }
+    }
+}
+
+static uint8_t md_covers(disc_t *disc, ucg_int_t x, ucg_int_t y)
+{
+    ucg_int_t dx = x - disc->x;
+    ucg_int_t dy = y - disc->y;
+
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+
+    return disc->visible && dx <= disc->rad && dy <= disc->span[dx];
+}
+
+/*
+ * What has to be written at (x,y) of a changed column of disc number z:
+ * 0 for nothing (a disc on top covers it), 1 for the background or
+ * i+2 for disc md_discs[i].
+ */
+static uint8_t md_column_pixel(disc_t *disc, uint8_t z, ucg_int_t x, ucg_int_t y)
+{
+    ucg_int_t dx, dy;
+    uint8_t i;
+
+    for (i = md_disc_count; i > z + 1; i--) {
+        if (md_covers(md_discs[i - 1], x, y)) {
+            return 0;
+        }
+    }
+
+    dx = x - disc->x;
+    dy = y - disc->y;
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+    if (dx <= disc->rad && dy <= disc->span[dx]) {
+        return z + 2;
+    }
+
+    for (i = z; i > 0; i--) {
+        if (md_covers(md_discs[i - 1], x, y)) {
+            return i + 1;
+        }
+    }
+
+    return 1;
+}
+
+static void md_flush_run(disc_t *disc, uint8_t z, uint8_t run,
+                         ucg_int_t x, ucg_int_t y, ucg_int_t len)
+{
+    color_t *c;
+
+    if (run == 0 || len <= 0) {
+        return;
+    }
+    if (run == 1) {
+        ucg_SetColor(disc->ucg, 0, 0, 0, 0);
+    } else {
+        c = (run - 2 == z) ? disc->color : md_discs[run - 2]->color;
+        ucg_SetColor(disc->ucg, 0, c->red, c->green, c->blue);
+    }
+    ucg_DrawVLine(disc->ucg, x, y, len);
+}
+
+/* Composite the rows ytop..ybot of column x and draw them in runs */
+static void md_draw_column(disc_t *disc, uint8_t z, ucg_int_t x,
+                           ucg_int_t ytop, ucg_int_t ybot)
+{
+    ucg_int_t y, start;
+    uint8_t run, p;
+
+    if (ytop < 0) {
+        ytop = 0;
+    }
+    if (ybot > Y_LINES - 1) {
+        ybot = Y_LINES - 1;
+    }
+    if (ytop > ybot) {
+        return;
+    }
+
+    start = ytop;
+    run = md_column_pixel(disc, z, x, ytop);
+    for (y = ytop + 1; y <= ybot; y++) {
+        p = md_column_pixel(disc, z, x, y);
+        if (p != run) {
+            md_flush_run(disc, z, run, x, start, y - start);
+            run = p;
+            start = y;
+        }
+    }
+    md_flush_run(disc, z, run, x, start, ybot + 1 - start);
+}
+#endif /* TILES */
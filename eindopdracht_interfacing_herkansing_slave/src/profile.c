@@ -0,0 +1,233 @@
+/*!
+ * \file    profile.c
+ * \brief   Scope timers for the main loop of the slave, see profile.h.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <stdio.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "serialF0.h"
+
+typedef struct {
+    uint16_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+} profile_scope_t;
+
+static const char *profile_names[PROF_SCOPES] = {
+    "parse", "disc1", "disc2", "disc3", "disc4", "l90fx", "spi_queue", "frame", "blit",
+    "spi_dma"
+};
+
+static profile_scope_t profile_scopes[PROF_SCOPES];
+static uint16_t profile_frames = 0;
+static ucg_dev_fnptr profile_device_cb;
+static ucg_com_fnptr profile_com_cb;
+static spi_dma_callback_t profile_idle_cb;
+static uint32_t profile_dma_start;
+static volatile uint8_t profile_dma_running = 0;
+
+static void profile_reset(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < PROF_SCOPES; i++) {
+        profile_scopes[i].count = 0;
+        profile_scopes[i].min = UINT32_MAX;
+        profile_scopes[i].max = 0;
+        profile_scopes[i].sum = 0;
+    }
+}
+
+void profile_init(void)
+{
+    PROFILE_TIMER_LOW.CTRLA = TC_CLKSEL_OFF_gc;
+    PROFILE_TIMER_HIGH.CTRLA = TC_CLKSEL_OFF_gc;
+
+    PROFILE_EV_OVF = EVSYS_CHMUX_TCD0_OVF_gc;
+
+    PROFILE_TIMER_LOW.CTRLB = TC_WGMODE_NORMAL_gc;
+    PROFILE_TIMER_LOW.PER = 0xFFFF;
+    PROFILE_TIMER_LOW.CNT = 0;
+    PROFILE_TIMER_HIGH.CTRLB = TC_WGMODE_NORMAL_gc;
+    PROFILE_TIMER_HIGH.PER = 0xFFFF;
+    PROFILE_TIMER_HIGH.CNT = 0;
+
+    PROFILE_TIMER_HIGH.CTRLA = TC_CLKSEL_EVCH2_gc;
+    PROFILE_TIMER_LOW.CTRLA = TC_CLKSEL_DIV1_gc;
+
+    profile_reset();
+}
+
+/* Read high, low, high: see timestamp_now() */
+uint32_t profile_now(void)
+{
+    uint16_t high, low;
+    uint8_t sreg = SREG;
+
+    cli();
+    do {
+        high = PROFILE_TIMER_HIGH.CNT;
+        low = PROFILE_TIMER_LOW.CNT;
+    } while (high != PROFILE_TIMER_HIGH.CNT);
+    SREG = sreg;
+
+    return ((uint32_t) high << 16) | low;
+}
+
+void profile_add(uint8_t id, uint32_t cycles)
+{
+    profile_scope_t *p = &profile_scopes[id];
+
+    p->count++;
+    p->sum += cycles;
+    if (cycles < p->min) {
+        p->min = cycles;
+    }
+    if (cycles > p->max) {
+        p->max = cycles;
+    }
+}
+
+void profile_frame(void)
+{
+    char line[48];
+    profile_scope_t p;
+    uint8_t i, sreg;
+
+    if (++profile_frames < PROFILE_DUMP_FRAMES) {
+        return;
+    }
+    profile_frames = 0;
+
+    uartF0_puts("scope,count,min,max,avg\n");
+    for (i = 0; i < PROF_SCOPES; i++) {
+        // spi_dma is added from the interrupt
+        sreg = SREG;
+        cli();
+        p = profile_scopes[i];
+        SREG = sreg;
+        if (p.count == 0) {
+            continue;
+        }
+        snprintf(line, sizeof(line), "%s,%u,%lu,%lu,%lu\n", profile_names[i],
+                 p.count, p.min, p.max, p.sum / p.count);
+        uartF0_puts(line);
+    }
+    sreg = SREG;
+    cli();
+    profile_reset();
+    SREG = sreg;
+}
+
+// From the DMA interrupt: the bus is idle, the running spi_dma scope ends
+static void profile_dma_idle(void)
+{
+    if (profile_dma_running) {
+        profile_dma_running = 0;
+        profile_add(PROF_SPI_DMA, profile_now() - profile_dma_start);
+    }
+}
+
+static void profile_idle_wrapper(void)
+{
+    profile_dma_idle();
+    if (profile_idle_cb != NULL) {
+        profile_idle_cb();
+    }
+}
+
+static ucg_int_t profile_dev_cb(ucg_t *ucg, ucg_int_t msg, void *data)
+{
+    ucg_int_t result;
+
+    switch (msg) {
+    case UCG_MSG_DRAW_L90FX: {
+        PROFILE_BEGIN(PROF_L90FX);
+        result = profile_device_cb(ucg, msg, data);
+        PROFILE_END(PROF_L90FX);
+        break;
+    }
+    case UCG_MSG_DRAW_BLIT: {
+        PROFILE_BEGIN(PROF_BLIT);
+        result = profile_device_cb(ucg, msg, data);
+        PROFILE_END(PROF_BLIT);
+        break;
+    }
+    default:
+        result = profile_device_cb(ucg, msg, data);
+        break;
+    }
+
+    return result;
+}
+
+static int16_t profile_com_cb_wrapper(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
+{
+    int16_t result;
+    uint8_t start = 0;
+
+    switch (msg) {
+    case UCG_COM_MSG_REPEAT_1_BYTE:
+    case UCG_COM_MSG_REPEAT_2_BYTES:
+    case UCG_COM_MSG_REPEAT_3_BYTES:
+    case UCG_COM_MSG_SEND_STR:
+        // Queued in spi_dma: on an idle bus this starts the spi_dma scope
+        start = !spi_dma_busy();
+        break;
+    case UCG_COM_MSG_SEND_BYTE:
+    case UCG_COM_MSG_SEND_CD_DATA_SEQUENCE:
+        break;
+    default:
+        return profile_com_cb(ucg, msg, arg, data);
+    }
+
+    if (start) {
+        profile_dma_start = profile_now();
+    }
+    PROFILE_BEGIN(PROF_SPI_QUEUE);
+    result = profile_com_cb(ucg, msg, arg, data);
+    PROFILE_END(PROF_SPI_QUEUE);
+
+    // No callback is pending on an idle bus, so this replaces none. It runs
+    // right away when the transfer is already done.
+    if (start) {
+        profile_dma_running = 1;
+        spi_dma_on_idle(profile_dma_idle);
+    }
+
+    return result;
+}
+
+/* Returns a device callback that times UCG_MSG_DRAW_L90FX and UCG_MSG_DRAW_BLIT of device_cb */
+ucg_dev_fnptr profile_wrap_device(ucg_dev_fnptr device_cb)
+{
+    profile_device_cb = device_cb;
+    return profile_dev_cb;
+}
+
+/* Returns a com callback that times the messages that send bytes */
+ucg_com_fnptr profile_wrap_com(ucg_com_fnptr com_cb)
+{
+    profile_com_cb = com_cb;
+    return profile_com_cb_wrapper;
+}
+
+/*
+ * Returns an idle callback for spi_dma_on_idle() that ends the spi_dma
+ * scope and then calls cb, so the scope still ends when cb replaces the
+ * callback of the profiler
+ */
+spi_dma_callback_t profile_wrap_idle(spi_dma_callback_t cb)
+{
+    profile_idle_cb = cb;
+    return profile_idle_wrapper;
+}
+
+#endif /* PROFILE */
@@ -3,6 +3,16 @@
 #include <stddef.h>
 #include <avr/io.h>
 
+// Ended by spi_end() from the interrupt of spi_dma.c
+static volatile uint8_t spi_transaction = 0;
+
+#ifdef SPI_STATS
+static spi_stats_t spi_stats;
+#define _count_edge() (spi_stats.cs_edges++)
+#else
+#define _count_edge()
+#endif
+
 static inline void _activate_slave(void);
 static inline void _deactivate_slave(void);
 
@@ -30,6 +40,7 @@ void spi_init(void)
 uint8_t spi_read_write(uint8_t data)
 {
     _activate_slave();
+    spi_count_bytes(1);
 
     SPI_DEV.DATA = data;
 
@@ -46,6 +57,7 @@ uint8_t spi_read_write(uint8_t data)
 void spi_write(uint8_t data)
 {
     _activate_slave();
+    spi_count_bytes(1);
 
     SPI_DEV.DATA = data;
 
@@ -53,33 +65,97 @@ void spi_write(uint8_t data)
     while (!(SPI_DEV.STATUS & SPI_IF_bm))
         ;
 
-    // Manually reset the interrupt flag since we're not reading here
-    SPI_DEV.INTCTRL &= ~SPI_IF_bm;
+    // Reading DATA after STATUS clears the interrupt flag
+    (void) SPI_DEV.DATA;
 
     _deactivate_slave();
 }
 
-void spi_write_block(uint8_t *data, uint16_t len)
+/*
+ * Send len bytes (up to 65535) with the slave selected once. The SPI has no
+ * transmit buffer, a write to DATA while a byte is shifted out is a write
+ * collision. So the next byte is fetched before waiting and written as soon
+ * as IF is set; reading STATUS and then writing DATA also clears IF, only
+ * the last byte needs a read of DATA.
+ */
+void spi_write_block(const uint8_t *data, uint16_t len)
 {
-    if (data != NULL) {
+    uint8_t next;
+
+    if (data != NULL && len > 0) {
         _activate_slave();
-        for (uint8_t i=0; i<len; i++) {
-            SPI_DEV.DATA = data[i];
+        spi_count_bytes(len);
+        SPI_DEV.DATA = *data++;
+        while (--len) {
+            next = *data++;
             while (!(SPI_DEV.STATUS & SPI_IF_bm))
                 ;
-            // Manually reset the interrupt flag since we're not reading here
-            SPI_DEV.INTCTRL &= ~SPI_IF_bm;
+            SPI_DEV.DATA = next;
         }
+        while (!(SPI_DEV.STATUS & SPI_IF_bm))
+            ;
+        (void) SPI_DEV.DATA;
         _deactivate_slave();
     }
 }
 
+void spi_begin(void)
+{
+    if (!spi_transaction) {
+        _activate_slave();
+        spi_transaction = 1;
+    }
+}
+
+void spi_end(void)
+{
+    if (spi_transaction) {
+        spi_transaction = 0;
+        _deactivate_slave();
+    }
+}
+
+void spi_select(void)
+{
+    _activate_slave();
+}
+
+void spi_deselect(void)
+{
+    _deactivate_slave();
+}
+
+#ifdef SPI_STATS
+void spi_count_bytes(uint32_t n)
+{
+    spi_stats.bytes += n;
+}
+
+void spi_get_stats(spi_stats_t *stats)
+{
+    *stats = spi_stats;
+}
+
+void spi_reset_stats(void)
+{
+    spi_stats.bytes = 0;
+    spi_stats.cs_edges = 0;
+}
+#endif
+
+// Within a transaction the chip select stays asserted
 static inline void _activate_slave()
 {
-    SPI_PORT.OUTCLR = SPI_SS_bm;
+    if (!spi_transaction) {
+        SPI_PORT.OUTCLR = SPI_SS_bm;
+        _count_edge();
+    }
 }
 
 static inline void _deactivate_slave()
 {
-    SPI_PORT.OUTSET = SPI_SS_bm;
+    if (!spi_transaction) {
+        SPI_PORT.OUTSET = SPI_SS_bm;
+        _count_edge();
+    }
 }
@@ -0,0 +1,276 @@
+#include "spi_dma.h"
+
+#include <stddef.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "spi.h"
+
+// A transfer: a number of blocks of block_len bytes from buf, followed by
+// one tail of tail_len bytes
+typedef struct {
+    uint16_t blocks;
+    uint8_t block_len;
+    uint8_t tail_len;
+    uint8_t buf[SPI_DMA_BUF_SIZE];
+} spi_dma_xfer_t;
+
+static spi_dma_xfer_t spi_dma_xfer[SPI_DMA_BUFS];
+
+// spi_dma_head is the transfer that is sent, the next spi_dma_queued - 1
+// ones wait behind it
+static volatile uint8_t spi_dma_head = 0;
+static volatile uint8_t spi_dma_queued = 0;
+static volatile uint8_t spi_dma_end_pending = 0;
+static volatile spi_dma_callback_t spi_dma_cb = NULL;
+
+static spi_dma_xfer_t *_claim(void);
+static void _queue(spi_dma_xfer_t *x);
+static uint8_t _next_transaction(void);
+static void _start(void);
+
+void spi_dma_init(void)
+{
+    DMA.CTRL = 0;
+    DMA.CTRL = DMA_RESET_bm;
+    while (DMA.CTRL & DMA_RESET_bm)
+        ;
+    DMA.CTRL = DMA_ENABLE_bm;
+
+    // Source is the buffer of the transfer, reloaded after every block so a
+    // block can be repeated. Destination is the fixed DATA register of the SPI
+    SPI_DMA_CH.ADDRCTRL =
+        DMA_CH_SRCRELOAD_BLOCK_gc  |
+        DMA_CH_SRCDIR_INC_gc       |
+        DMA_CH_DESTRELOAD_NONE_gc  |
+        DMA_CH_DESTDIR_FIXED_gc;
+    SPI_DMA_CH.TRIGSRC = DMA_CH_TRIGSRC_SPID_gc;
+    SPI_DMA_CH.SRCADDR2 = 0;
+    SPI_DMA_CH.DESTADDR0 = (uint8_t) ((uint16_t) &SPI_DEV.DATA);
+    SPI_DMA_CH.DESTADDR1 = (uint8_t) ((uint16_t) &SPI_DEV.DATA >> 8);
+    SPI_DMA_CH.DESTADDR2 = 0;
+    SPI_DMA_CH.CTRLB = DMA_CH_TRNINTLVL_LO_gc;
+
+    PMIC.CTRL |= PMIC_LOLVLEN_bm;
+}
+
+/*
+ * Call cb once when the transfers that are queued now are done, or right
+ * away when nothing is queued. A new call replaces a callback that has not
+ * run yet.
+ */
+void spi_dma_on_idle(spi_dma_callback_t cb)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    if (spi_dma_queued) {
+        spi_dma_cb = cb;
+        cb = NULL;
+    }
+    SREG = sreg;
+
+    if (cb != NULL) {
+        cb();
+    }
+}
+
+void spi_dma_write(const uint8_t *data, uint16_t len)
+{
+    spi_dma_xfer_t *x;
+
+    if (data == NULL || len == 0) {
+        return;
+    }
+
+    if (len > SPI_DMA_BUF_SIZE) {
+        // Does not fit in a buffer, send it the old way
+        spi_dma_wait();
+        spi_write_block(data, len);
+        return;
+    }
+
+    x = _claim();
+    for (uint8_t i = 0; i < len; i++) {
+        x->buf[i] = data[i];
+    }
+    x->blocks = 0;
+    x->block_len = 0;
+    x->tail_len = len;
+    _queue(x);
+}
+
+void spi_dma_repeat(const uint8_t *pattern, uint8_t size, uint16_t count)
+{
+    spi_dma_xfer_t *x;
+    uint8_t n, i;
+
+    if (pattern == NULL || size == 0 || size > SPI_DMA_BUF_SIZE || count == 0) {
+        return;
+    }
+
+    x = _claim();
+
+    // Fill the buffer with as many copies of the pattern as fit, so one
+    // block sends n patterns and the DMA interrupt runs less often
+    n = SPI_DMA_BUF_SIZE / size;
+    if (count < n) {
+        n = count;
+    }
+    for (i = 0; i < n * size; i++) {
+        x->buf[i] = pattern[i % size];
+    }
+    x->blocks = count / n;
+    x->block_len = n * size;
+    x->tail_len = (count % n) * size;
+    _queue(x);
+}
+
+/* End the SPI transaction when the queued transfers are done */
+void spi_dma_end(void)
+{
+    uint8_t sreg = SREG;
+
+    cli();
+    if (spi_dma_queued) {
+        spi_dma_end_pending = 1;
+    } else {
+        spi_end();
+    }
+    SREG = sreg;
+}
+
+uint8_t spi_dma_busy(void)
+{
+    return spi_dma_queued != 0;
+}
+
+void spi_dma_wait(void)
+{
+    while (spi_dma_queued)
+        ;
+}
+
+/*
+ * The buffer for the next transfer. Only waits when all buffers are still
+ * queued. The interrupt moves the head and the number of queued transfers
+ * together, so the free buffer stays the same until it is queued.
+ */
+static spi_dma_xfer_t *_claim(void)
+{
+    uint8_t i;
+    uint8_t sreg;
+
+    while (spi_dma_queued == SPI_DMA_BUFS)
+        ;
+
+    sreg = SREG;
+    cli();
+    i = (spi_dma_head + spi_dma_queued) % SPI_DMA_BUFS;
+    SREG = sreg;
+
+    return &spi_dma_xfer[i];
+}
+
+/* Queue the buffer returned by _claim(), start it when the bus is idle */
+static void _queue(spi_dma_xfer_t *x)
+{
+    uint8_t sreg = SREG;
+
+    spi_count_bytes((uint32_t) x->blocks * x->block_len + x->tail_len);
+
+    cli();
+    if (spi_dma_queued++ == 0) {
+        _start();
+    }
+    SREG = sreg;
+}
+
+/*
+ * Program the channel for the next part of the head transfer and request
+ * the first byte. The following bytes are triggered by the SPI flag.
+ * Returns 0 when there is nothing left to send.
+ */
+static uint8_t _next_transaction(void)
+{
+    spi_dma_xfer_t *x = &spi_dma_xfer[spi_dma_head];
+    uint8_t reps;
+
+    if (x->blocks > 0) {
+        reps = (x->blocks > 255) ? 255 : x->blocks;
+        x->blocks -= reps;
+        SPI_DMA_CH.TRFCNT = x->block_len;
+        SPI_DMA_CH.REPCNT = reps;
+    } else if (x->tail_len > 0) {
+        SPI_DMA_CH.TRFCNT = x->tail_len;
+        SPI_DMA_CH.REPCNT = 1;
+        x->tail_len = 0;
+    } else {
+        return 0;
+    }
+
+    SPI_DMA_CH.CTRLA =
+        DMA_CH_ENABLE_bm          |
+        DMA_CH_REPEAT_bm          |
+        DMA_CH_SINGLE_bm          |
+        DMA_CH_BURSTLEN_1BYTE_gc;
+    SPI_DMA_CH.CTRLA |= DMA_CH_TRFREQ_bm;
+
+    return 1;
+}
+
+// Start the head transfer, called with interrupts off
+static void _start(void)
+{
+    uint8_t *buf = spi_dma_xfer[spi_dma_head].buf;
+
+    // Clear a pending SPI flag, otherwise it triggers an extra transfer
+    (void) SPI_DEV.STATUS;
+    (void) SPI_DEV.DATA;
+
+    SPI_DMA_CH.SRCADDR0 = (uint8_t) ((uint16_t) buf);
+    SPI_DMA_CH.SRCADDR1 = (uint8_t) ((uint16_t) buf >> 8);
+    spi_select();
+    _next_transaction();
+}
+
+/*
+ * The DMA is done when the last byte is written to DATA, not when it is
+ * shifted out. The SPI interrupt of that byte continues the queue, so the
+ * CPU does not wait for it here; while the DMA runs the SPI interrupt is
+ * off, the flag only triggers the channel.
+ */
+ISR(SPI_DMA_CH_vect)
+{
+    SPI_DMA_CH.CTRLB |= DMA_CH_TRNIF_bm | DMA_CH_ERRIF_bm;
+    SPI_DEV.INTCTRL = SPI_INTLVL_LO_gc;
+}
+
+// The last byte of a part is shifted out, the flag is cleared by the vector
+ISR(SPI_DMA_SPI_vect)
+{
+    spi_dma_callback_t cb;
+
+    SPI_DEV.INTCTRL = SPI_INTLVL_OFF_gc;
+
+    if (_next_transaction()) {
+        return;
+    }
+
+    // The head transfer is done, its buffer is free again
+    spi_deselect();
+    spi_dma_head = (spi_dma_head + 1) % SPI_DMA_BUFS;
+    if (--spi_dma_queued) {
+        _start();
+        return;
+    }
+
+    if (spi_dma_end_pending) {
+        spi_dma_end_pending = 0;
+        spi_end();
+    }
+    cb = spi_dma_cb;
+    spi_dma_cb = NULL;
+    if (cb != NULL) {
+        cb();
+    }
+}
@@ -0,0 +1,129 @@
+/*!
+ * \file    sprite.c
+ * \brief   RAM sprites of the discs in the pixel format of the display,
+ *          see sprite.h.
+ * \version 1.1
+ * \date    16-10-2026
+ */
+#include "sprite.h"
+
+#include <string.h>
+
+/* Convert a color to the pixel format of the display */
+void sprite_pack(const color_t *c, uint8_t *p)
+{
+#ifdef UCGLIB_PIXEL_16BIT
+    p[0] = (c->red & 0xf8) | (c->green >> 5);
+    p[1] = ((c->green << 3) & 0xe0) | (c->blue >> 3);
+#else
+    p[0] = c->red;
+    p[1] = c->green;
+    p[2] = c->blue;
+#endif
+}
+
+#ifdef SPRITES
+
+#define SPRITE_STR(x)   #x
+#define SPRITE_XSTR(x)  SPRITE_STR(x)
+
+/* The preprocessor cannot print the sum, so the message gives its terms */
+#pragma message("sprite RAM: " SPRITE_XSTR(SPRITE_COUNT) " sprites of radius " \
+                SPRITE_XSTR(SPRITE_MAX_RAD) " and a box for moves of " \
+                SPRITE_XSTR(SPRITE_MAX_MOVE) ", " SPRITE_XSTR(SPRITE_BPP) " bytes per pixel")
+
+#if SPRITE_RAM_BYTES > SPRITE_RAM_BUDGET
+#error "sprites do not fit in SPRITE_RAM_BUDGET"
+#endif
+
+typedef struct {
+    disc_t *disc;   // owner, NULL for a free sprite
+    uint8_t pixels[SPRITE_BYTES];
+} sprite_t;
+
+static sprite_t sprite_pool[SPRITE_COUNT];
+static uint8_t sprite_box[SPRITE_BOX_BYTES];
+
+/*
+ * Render the disc into a sprite. Returns the pixels, or NULL when the disc
+ * is too large or the pool is full. A disc that already has a sprite gets
+ * it rendered again.
+ */
+uint8_t *sprite_create(disc_t *disc)
+{
+    sprite_t *s = NULL;
+    uint8_t color[SPRITE_BPP];
+    uint8_t *p;
+    ucg_int_t size, x, y, dx, dy;
+    uint8_t i;
+
+    if (disc == NULL || disc->rad > SPRITE_MAX_RAD) {
+        return NULL;
+    }
+
+    for (i = 0; i < SPRITE_COUNT; i++) {
+        if (sprite_pool[i].disc == disc) {
+            s = &sprite_pool[i];
+            break;
+        }
+        if (s == NULL && sprite_pool[i].disc == NULL) {
+            s = &sprite_pool[i];
+        }
+    }
+    if (s == NULL) {
+        return NULL;
+    }
+    s->disc = disc;
+
+    sprite_pack(disc->color, color);
+    size = 2 * disc->rad + 1;
+    p = s->pixels;
+    for (y = 0; y < size; y++) {
+        for (x = 0; x < size; x++) {
+            dx = x - disc->rad;
+            dy = y - disc->rad;
+            if (dx < 0) dx = -dx;
+            if (dy < 0) dy = -dy;
+            if (dy <= disc->span[dx]) {
+                memcpy(p, color, SPRITE_BPP);
+            } else {
+                memset(p, 0, SPRITE_BPP);
+            }
+            p += SPRITE_BPP;
+        }
+    }
+
+    return s->pixels;
+}
+
+/*
+ * Send the box bx/by w x h with the disc at its current position on a
+ * black background in one blit. Returns 0 when the box is too large or
+ * the display could not draw it (not completely on the screen); nothing
+ * has been drawn then.
+ */
+uint8_t sprite_blit(disc_t *disc, ucg_int_t bx, ucg_int_t by, ucg_int_t w, ucg_int_t h)
+{
+    ucg_int_t size, line, y;
+    uint8_t *dst;
+    const uint8_t *src;
+
+    if (disc->sprite == NULL || w > SPRITE_BOX_SIZE || h > SPRITE_BOX_SIZE) {
+        return 0;
+    }
+
+    size = 2 * disc->rad + 1;
+    line = size * SPRITE_BPP;
+    memset(sprite_box, 0, (uint16_t) w * h * SPRITE_BPP);
+    dst = sprite_box + ((disc->y - disc->rad - by) * w + (disc->x - disc->rad - bx)) * SPRITE_BPP;
+    src = disc->sprite;
+    for (y = 0; y < size; y++) {
+        memcpy(dst, src, line);
+        dst += w * SPRITE_BPP;
+        src += line;
+    }
+
+    return ucg_DrawNativeBlit(disc->ucg, bx, by, w, h, sprite_box) != 0;
+}
+
+#endif /* SPRITES */
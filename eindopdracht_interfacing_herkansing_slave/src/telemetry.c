@@ -0,0 +1,301 @@
+/*!
+ * \file    telemetry.c
+ * \brief   Encoding and decoding of the binary telemetry packet. The
+ *          fields are written byte by byte, so the layout does not depend
+ *          on the struct padding or the byte order of the compiler.
+ * \version 2.3
+ * \date    16-10-2026
+ */
+#include "telemetry.h"
+
+#include <stddef.h>
+
+static void put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t) v;
+    p[1] = (uint8_t) (v >> 8);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t) p[0] | ((uint16_t) p[1] << 8);
+}
+
+/*
+ * Writes the change from prev to v as a zig-zag varint at p, if it fits
+ * before end. Returns the number of bytes, or 0 when it does not fit.
+ */
+static uint8_t put_delta(uint8_t *p, const uint8_t *end, int16_t v, int16_t prev)
+{
+    int16_t d = (int16_t) ((uint16_t) v - (uint16_t) prev);
+    uint16_t z = ((uint16_t) d << 1) ^ (uint16_t) (d >> 15);
+    uint8_t n = 0;
+
+    do {
+        if (p + n >= end) {
+            return 0;
+        }
+        p[n] = (uint8_t) (z & 0x7f);
+        z >>= 7;
+        if (z) {
+            p[n] |= 0x80;
+        }
+        n++;
+    } while (z);
+
+    return n;
+}
+
+/*
+ * Checks that p up to end holds exactly count varints of at most
+ * TELEMETRY_DELTA_MAX_BYTES bytes each.
+ */
+static uint8_t check_deltas(const uint8_t *p, const uint8_t *end, uint8_t count)
+{
+    uint8_t n;
+
+    while (count--) {
+        n = 0;
+        do {
+            if (p >= end || n == TELEMETRY_DELTA_MAX_BYTES) {
+                return TELEMETRY_ERR_LENGTH;
+            }
+            n++;
+        } while (*p++ & 0x80);
+    }
+
+    return (p == end) ? TELEMETRY_OK : TELEMETRY_ERR_LENGTH;
+}
+
+/* Reads a checked zig-zag varint at p and adds it to v. Returns the number of bytes. */
+static uint8_t get_delta(const uint8_t *p, int16_t *v)
+{
+    uint16_t z = 0;
+    uint8_t n = 0;
+
+    do {
+        z |= (uint16_t) (p[n] & 0x7f) << (7 * n);
+    } while (p[n++] & 0x80);
+
+    *v = (int16_t) ((uint16_t) *v + ((z >> 1) ^ (uint16_t) -(z & 1)));
+
+    return n;
+}
+
+/*
+ * The mean time between the samples, so the slave can give every sample its
+ * own time. Saturates at 65535 us.
+ */
+static uint16_t sample_period(const telemetry_sample_t *s, uint8_t count)
+{
+    uint32_t period;
+
+    if (count < 2) {
+        return 0;
+    }
+    period = (s[count - 1].timestamp - s[0].timestamp) / (count - 1);
+
+    return (period > 0xffff) ? 0xffff : (uint16_t) period;
+}
+
+static void put_header(uint8_t *buf, uint8_t version, const telemetry_sample_t *s,
+                       uint8_t count)
+{
+    buf[0] = version;
+    buf[1] = count;
+    put16(&buf[2], s[0].seq);
+    put16(&buf[4], (uint16_t) s[0].timestamp);
+    put16(&buf[6], (uint16_t) (s[0].timestamp >> 16));
+    put16(&buf[8], sample_period(s, count));
+}
+
+/*
+ * Writes count samples into buf. The sequence number and timestamp of the
+ * first sample and the sample period go into the header. Returns the
+ * length of the packet, or 0 when count is out of range or buf is too
+ * small.
+ */
+uint8_t telemetry_encode(const telemetry_sample_t *s, uint8_t count,
+                         uint8_t *buf, uint8_t size)
+{
+    uint8_t i;
+    uint8_t *p;
+
+    if (s == NULL || buf == NULL || count == 0 || count > TELEMETRY_MAX_BATCH
+            || size < TELEMETRY_SIZE(count)) {
+        return 0;
+    }
+
+    put_header(buf, TELEMETRY_VERSION, s, count);
+
+    p = &buf[TELEMETRY_HEADER_SIZE];
+    for (i = 0; i < count; i++) {
+        put16(&p[0], (uint16_t) s[i].x);
+        put16(&p[2], (uint16_t) s[i].y);
+        put16(&p[4], (uint16_t) s[i].z);
+        p += TELEMETRY_SAMPLE_SIZE;
+    }
+
+    return TELEMETRY_SIZE(count);
+}
+
+/*
+ * Writes a compact packet with up to count samples into buf: as many as fit
+ * in size bytes, at most TELEMETRY_DELTA_MAX_BATCH. When the changes are so
+ * large that a fixed packet holds more samples, the fixed packet is written
+ * instead. The number of samples that went in is returned in used, the
+ * rest is left for the next packet. Returns the length of the packet, or 0
+ * when count is 0 or buf is too small for one sample.
+ */
+uint8_t telemetry_encode_delta(const telemetry_sample_t *s, uint8_t count,
+                               uint8_t *buf, uint8_t size, uint8_t *used)
+{
+    uint8_t i, nx, ny, nz, fixed;
+    uint8_t *p;
+    const uint8_t *end;
+
+    if (s == NULL || buf == NULL || used == NULL || count == 0
+            || size < TELEMETRY_DELTA_HEADER_SIZE) {
+        return 0;
+    }
+    if (count > TELEMETRY_DELTA_MAX_BATCH) {
+        count = TELEMETRY_DELTA_MAX_BATCH;
+    }
+
+    p = &buf[TELEMETRY_HEADER_SIZE];
+    put16(&p[0], (uint16_t) s[0].x);
+    put16(&p[2], (uint16_t) s[0].y);
+    put16(&p[4], (uint16_t) s[0].z);
+    p += TELEMETRY_SAMPLE_SIZE;
+
+    end = buf + size;
+    for (i = 1; i < count; i++) {
+        if ((nx = put_delta(p, end, s[i].x, s[i - 1].x)) == 0 ||
+            (ny = put_delta(p + nx, end, s[i].y, s[i - 1].y)) == 0 ||
+            (nz = put_delta(p + nx + ny, end, s[i].z, s[i - 1].z)) == 0) {
+            break;
+        }
+        p += nx + ny + nz;
+    }
+
+    fixed = (count < TELEMETRY_MAX_BATCH) ? count : TELEMETRY_MAX_BATCH;
+    if (i < fixed && size >= TELEMETRY_SIZE(fixed)) {
+        *used = fixed;
+        return telemetry_encode(s, fixed, buf, size);
+    }
+
+    put_header(buf, TELEMETRY_VERSION_DELTA, s, i);
+    *used = i;
+
+    return (uint8_t) (p - buf);
+}
+
+/*
+ * Reads the samples from a received packet of len bytes into s, which has
+ * room for max samples. Both the fixed and the compact packet are read.
+ * Sample i gets the timestamp of the header plus i periods. Returns
+ * TELEMETRY_OK and the number of samples in count, or an error code when
+ * the length does not match or the version is unknown; s and count are not
+ * changed then. The time is bounded by len: the deltas are checked in one
+ * pass over the bytes and read in a second.
+ */
+uint8_t telemetry_decode(telemetry_sample_t *s, uint8_t max, uint8_t *count,
+                         const uint8_t *buf, uint8_t len)
+{
+    uint8_t i, n;
+    uint16_t seq, period;
+    uint32_t timestamp;
+    const uint8_t *p;
+
+    if (s == NULL || count == NULL || buf == NULL || len < TELEMETRY_HEADER_SIZE) {
+        return TELEMETRY_ERR_LENGTH;
+    }
+    n = buf[1];
+    if (buf[0] == TELEMETRY_VERSION) {
+        if (n == 0 || n > max || n > TELEMETRY_MAX_BATCH || len != TELEMETRY_SIZE(n)) {
+            return TELEMETRY_ERR_LENGTH;
+        }
+    } else if (buf[0] == TELEMETRY_VERSION_DELTA) {
+        if (n == 0 || n > max || n > TELEMETRY_DELTA_MAX_BATCH
+                || len < TELEMETRY_DELTA_HEADER_SIZE
+                || check_deltas(&buf[TELEMETRY_DELTA_HEADER_SIZE], buf + len,
+                                3 * (n - 1)) != TELEMETRY_OK) {
+            return TELEMETRY_ERR_LENGTH;
+        }
+    } else {
+        return TELEMETRY_ERR_VERSION;
+    }
+
+    seq = get16(&buf[2]);
+    timestamp = (uint32_t) get16(&buf[4]) | ((uint32_t) get16(&buf[6]) << 16);
+    period = get16(&buf[8]);
+
+    p = &buf[TELEMETRY_HEADER_SIZE];
+    for (i = 0; i < n; i++) {
+        s[i].seq = seq + i;
+        s[i].timestamp = timestamp;
+        timestamp += period;
+        if (buf[0] == TELEMETRY_VERSION || i == 0) {
+            s[i].x = (int16_t) get16(&p[0]);
+            s[i].y = (int16_t) get16(&p[2]);
+            s[i].z = (int16_t) get16(&p[4]);
+            p += TELEMETRY_SAMPLE_SIZE;
+        } else {
+            s[i].x = s[i - 1].x;
+            s[i].y = s[i - 1].y;
+            s[i].z = s[i - 1].z;
+            p += get_delta(p, &s[i].x);
+            p += get_delta(p, &s[i].y);
+            p += get_delta(p, &s[i].z);
+        }
+    }
+    *count = n;
+
+    return TELEMETRY_OK;
+}
+
+/*
+ * Writes the acknowledge payload of the slave into buf. Returns its length,
+ * or 0 when buf is too small.
+ */
+uint8_t telemetry_encode_ack(uint16_t received, uint8_t *buf, uint8_t size)
+{
+    if (buf == NULL || size < TELEMETRY_ACK_SIZE) {
+        return 0;
+    }
+
+    buf[0] = TELEMETRY_VERSION;
+    put16(&buf[1], received);
+
+    return TELEMETRY_ACK_SIZE;
+}
+
+/*
+ * Reads an acknowledge payload of len bytes. Returns TELEMETRY_OK or an
+ * error code; received is not changed then.
+ */
+uint8_t telemetry_decode_ack(uint16_t *received, const uint8_t *buf, uint8_t len)
+{
+    if (received == NULL || buf == NULL || len != TELEMETRY_ACK_SIZE) {
+        return TELEMETRY_ERR_LENGTH;
+    }
+    if (buf[0] != TELEMETRY_VERSION) {
+        return TELEMETRY_ERR_VERSION;
+    }
+
+    *received = get16(&buf[1]);
+
+    return TELEMETRY_OK;
+}
+
+/*
+ * Air time in microseconds of one packet with a payload of len bytes at
+ * 250 kbps (4 us per bit), including the acknowledge and the two 130 us
+ * TX/RX turnarounds. A packet is a preamble (1 byte), the address
+ * (5 bytes), the packet control field (9 bits), the payload and a 16 bit
+ * CRC; the acknowledge is the same packet without payload.
+ */
+uint16_t telemetry_airtime_us(uint8_t len)
+{
+    return TELEMETRY_AIRTIME_US(len);
+}
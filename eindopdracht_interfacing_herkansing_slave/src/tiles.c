@@ -0,0 +1,196 @@
+/*!
+ * \file    tiles.c
+ * \brief   Tile based renderer for the discs, see tiles.h.
+ * \version 1.3
+ * \date    16-10-2026
+ */
+#include "tiles.h"
+
+#ifdef TILES
+
+#include <string.h>
+
+#if TILES_X * TILE_W != X_LINES || TILES_Y * TILE_H != Y_LINES
+#error "the tile size must divide the screen size"
+#endif
+
+#if TILES_RAM_BYTES > TILES_RAM_BUDGET
+#error "the tiles do not fit in TILES_RAM_BUDGET"
+#endif
+
+/* Dirty area of a tile in screen coordinates, x1/y1 exclusive; x1 = 0 for a clean tile */
+typedef struct {
+    uint8_t x0;
+    uint8_t y0;
+    uint8_t x1;
+    uint8_t y1;
+} tile_dirty_t;
+
+static tile_dirty_t tile_dirty[TILES_Y][TILES_X];
+static uint8_t tile_buf[TILE_W * TILE_H * TILE_BPP];
+
+/* Mark the area x/y w x h as dirty, parts outside the screen are ignored */
+void tiles_mark(ucg_int_t x, ucg_int_t y, ucg_int_t w, ucg_int_t h)
+{
+    ucg_int_t x1 = x + w;
+    ucg_int_t y1 = y + h;
+    ucg_int_t tx, ty, ax0, ay0, ax1, ay1;
+    tile_dirty_t *t;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x1 > X_LINES) x1 = X_LINES;
+    if (y1 > Y_LINES) y1 = Y_LINES;
+    if (x >= x1 || y >= y1) {
+        return;
+    }
+
+    for (ty = y / TILE_H; ty <= (y1 - 1) / TILE_H; ty++) {
+        for (tx = x / TILE_W; tx <= (x1 - 1) / TILE_W; tx++) {
+            // Part of the area inside this tile
+            ax0 = tx * TILE_W;
+            ay0 = ty * TILE_H;
+            ax1 = ax0 + TILE_W;
+            ay1 = ay0 + TILE_H;
+            if (ax0 < x) ax0 = x;
+            if (ay0 < y) ay0 = y;
+            if (ax1 > x1) ax1 = x1;
+            if (ay1 > y1) ay1 = y1;
+
+            t = &tile_dirty[ty][tx];
+            if (t->x1 == 0) {
+                t->x0 = ax0;
+                t->y0 = ay0;
+                t->x1 = ax1;
+                t->y1 = ay1;
+            } else {
+                if (ax0 < t->x0) t->x0 = ax0;
+                if (ay0 < t->y0) t->y0 = ay0;
+                if (ax1 > t->x1) t->x1 = ax1;
+                if (ay1 > t->y1) t->y1 = ay1;
+            }
+        }
+    }
+}
+
+/* Draw the part of the disc inside the area x0/y0 w x h into tile_buf */
+static void tiles_draw_disc(disc_t *disc, ucg_int_t x0, ucg_int_t y0,
+                            ucg_int_t w, ucg_int_t h)
+{
+    uint8_t color[TILE_BPP];
+    ucg_int_t x, xs, xe, top, bot, y, dx;
+    uint8_t *p;
+
+    xs = disc->x - disc->rad;
+    xe = disc->x + disc->rad;
+    if (xs < x0) xs = x0;
+    if (xe > x0 + w - 1) xe = x0 + w - 1;
+    if (xs > xe || disc->y + disc->rad < y0 || disc->y - disc->rad > y0 + h - 1) {
+        return;
+    }
+
+    sprite_pack(disc->color, color);
+    for (x = xs; x <= xe; x++) {
+        dx = x - disc->x;
+        if (dx < 0) dx = -dx;
+        top = disc->y - disc->span[dx];
+        bot = disc->y + disc->span[dx];
+        if (top < y0) top = y0;
+        if (bot > y0 + h - 1) bot = y0 + h - 1;
+        p = tile_buf + ((top - y0) * w + (x - x0)) * TILE_BPP;
+        for (y = top; y <= bot; y++) {
+            memcpy(p, color, TILE_BPP);
+            p += w * TILE_BPP;
+        }
+    }
+}
+
+/* The top visible disc at x/y, NULL for the background */
+static disc_t *tiles_disc_at(ucg_int_t x, ucg_int_t y)
+{
+    disc_t *disc, *top = NULL;
+    ucg_int_t dx, dy;
+    uint8_t z;
+
+    for (z = 0; (disc = md_get_disc(z)) != NULL; z++) {
+        dx = x - disc->x;
+        dy = y - disc->y;
+        if (dx < 0) dx = -dx;
+        if (dy < 0) dy = -dy;
+        if (disc->visible && dx <= disc->rad && dy <= disc->span[dx]) {
+            top = disc;
+        }
+    }
+
+    return top;
+}
+
+static void tiles_draw_run(ucg_t *ucg, disc_t *disc, ucg_int_t x, ucg_int_t y, ucg_int_t len)
+{
+    if (disc == NULL) {
+        ucg_SetColor(ucg, 0, 0, 0, 0);
+    } else {
+        ucg_SetColor(ucg, 0, disc->color->red, disc->color->green, disc->color->blue);
+    }
+    ucg_DrawHLine(ucg, x, y, len);
+}
+
+/*
+ * Draw the area x0/y0 w x h line by line in runs of one color, for when
+ * the display does not take the blit (it is not inside the clip box). The
+ * lines are clipped by ucglib.
+ */
+static void tiles_draw_lines(ucg_t *ucg, ucg_int_t x0, ucg_int_t y0,
+                             ucg_int_t w, ucg_int_t h)
+{
+    ucg_int_t x, y, start;
+    disc_t *run, *next;
+
+    for (y = y0; y < y0 + h; y++) {
+        start = x0;
+        run = tiles_disc_at(x0, y);
+        for (x = x0 + 1; x < x0 + w; x++) {
+            next = tiles_disc_at(x, y);
+            if (next != run) {
+                tiles_draw_run(ucg, run, start, y, x - start);
+                start = x;
+                run = next;
+            }
+        }
+        tiles_draw_run(ucg, run, start, y, x0 + w - start);
+    }
+}
+
+/* Rasterize and send every dirty area, one address window per tile */
+void tiles_flush(ucg_t *ucg)
+{
+    ucg_int_t tx, ty, w, h;
+    tile_dirty_t *t;
+    disc_t *disc;
+    uint8_t z;
+
+    for (ty = 0; ty < TILES_Y; ty++) {
+        for (tx = 0; tx < TILES_X; tx++) {
+            t = &tile_dirty[ty][tx];
+            if (t->x1 == 0) {
+                continue;
+            }
+            w = t->x1 - t->x0;
+            h = t->y1 - t->y0;
+
+            memset(tile_buf, 0, (uint16_t) w * h * TILE_BPP);
+            for (z = 0; (disc = md_get_disc(z)) != NULL; z++) {
+                if (disc->visible) {
+                    tiles_draw_disc(disc, t->x0, t->y0, w, h);
+                }
+            }
+            if (!ucg_DrawNativeBlit(ucg, t->x0, t->y0, w, h, tile_buf)) {
+                tiles_draw_lines(ucg, t->x0, t->y0, w, h);
+            }
+
+            t->x1 = 0;
+        }
+    }
+}
+
+#endif /* TILES */
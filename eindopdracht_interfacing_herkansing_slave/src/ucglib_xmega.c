@@ -5,6 +5,7 @@
 #define F_CPU 32000000UL
 #include <util/delay.h>
 #include "spi.h"
+#include "spi_dma.h"
 
 static void my_init_spi_xmega(uint16_t sclk_period_ns);
 
@@ -12,6 +13,25 @@ static void my_delay_us(uint16_t);
 
 int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
 {
+    // The CD and CS lines, and the blocking writes, may only be used when
+    // the queued DMA transfers are finished. The data messages queue behind
+    // them and only wait when all DMA buffers are in use.
+    switch(msg) {
+    case UCG_COM_MSG_REPEAT_1_BYTE:
+    case UCG_COM_MSG_REPEAT_2_BYTES:
+    case UCG_COM_MSG_REPEAT_3_BYTES:
+    case UCG_COM_MSG_SEND_STR:
+        break;
+    case UCG_COM_MSG_CHANGE_CS_LINE:
+        if (arg == 0) {
+            spi_dma_wait();
+        }
+        break;
+    default:
+        spi_dma_wait();
+        break;
+    }
+
     switch(msg) {
     case UCG_COM_MSG_POWER_UP:
         /* "data" is a pointer to ucg_com_info_t structure with the following
@@ -64,10 +84,13 @@ int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
         /* "data" is not used */
         /* "arg" = 1: set the chipselect output line to 1 */
         /* "arg" = 0: set the chipselect output line to 0 */
+        /* A low chipselect starts an SPI transaction, all bytes up to */
+        /* the next high chipselect are sent without toggling the line. */
+        /* The transaction ends when the queued DMA transfers are done. */
         if (arg) {
-            SPI_PORT.OUTSET = SPI_SS_bm;
+            spi_dma_end();
         } else {
-            SPI_PORT.OUTCLR = SPI_SS_bm;
+            spi_begin();
         }
 
         break;
@@ -84,9 +107,7 @@ int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
         /* repeat sending the byte in data[0] "arg" times */
         /* The current status of the CD line is available */
         /* in bit 0 of u8g->com_status */
-        while (arg--) {
-            spi_write(data[0]);
-        }
+        spi_dma_repeat(data, 1, arg);
 
         break;
     case UCG_COM_MSG_REPEAT_2_BYTES:
@@ -95,9 +116,7 @@ int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
         /* repeat sending the two bytes "arg" times */
         /* The current status of the CD line is available */
         /* in bit 0 of u8g->com_status */
-        while (arg--) {
-            spi_write_block(data, 2);
-        }
+        spi_dma_repeat(data, 2, arg);
 
         break;
     case UCG_COM_MSG_REPEAT_3_BYTES:
@@ -107,15 +126,13 @@ int16_t ucg_com_xmega_cb(ucg_t *ucg, int16_t msg, uint16_t arg, uint8_t *data)
         /* repeat sending the three bytes "arg" times */
         /* The current status of the CD line is available */
         /* in bit 0 of u8g->com_status */
-        while (arg--) {
-            spi_write_block(data, 3);
-        }
+        spi_dma_repeat(data, 3, arg);
 
         break;
     case UCG_COM_MSG_SEND_STR:
         /* "data" is an array with "arg" bytes */
         /* send "arg" bytes to the display */
-        spi_write_block(data, arg);
+        spi_dma_write(data, arg);
 
         break;
     case UCG_COM_MSG_SEND_CD_DATA_SEQUENCE:
@@ -156,6 +173,7 @@ static void my_init_spi_xmega(uint16_t sclk_period_ns)
     UCGLIB_PORT.OUTCLR = (UCGLIB_RST_bm | UCGLIB_CD_bm);
 
     spi_init();
+    spi_dma_init();
 }
 
 static void my_delay_us(uint16_t us)